@@ -14,23 +14,85 @@
 #include "src/Drivers/ServoDriver.h"
 #include "src/Drivers/Buttons.h"
 #include "src/Drivers/MotorDriver.h"
+#include "src/Drivers/I2CBus.h"
 #include "src/Logic/Filters.h"
 #include "src/Logic/FFTProcessor.h"
+#include "src/Logic/FFTChannels.h"
 #include "src/Logic/SlipDetection.h"
 #include "src/Logic/GrippingFSM.h"
 #include "src/Logic/DebugTask.h"
+#include "src/Logic/TimingMonitor.h"
+#include "src/Logic/Scheduler.h"
+#include "src/Logic/SampleRing.h"
+#include "src/Logic/SignalGraph.h"
+#include "src/Logic/OnlineCalibration.h"
+#include "src/Logic/BootTimeline.h"
+#include "src/Logic/Experiment.h"
 
 unsigned long cycleCounter = 0;
-// Sampling dividers (base frequency 2kHz)
-const int CURRENT_READ_DIVIDER = 20;  // ~100Hz
-const int BUTTON_READ_DIVIDER = 100;  // ~20Hz
+
+// All state of the scan cycle; passed explicitly to the logic modules
+ControlState controlState;
+
+// Magnetic samples collected for block processing (DSP_BLOCK_SIZE)
+MagneticData magBlock[DSP_BLOCK_SIZE];
+float magBlockRaw[DSP_BLOCK_SIZE][3];  // Same samples before calibration and filtering (capture only)
+uint8_t magBlockFill = 0;
+bool magBlockReady = false;
+
+void controlTaskFunction(void* parameter);
+void liftBringUpTask(void* parameter);
+void readMagneticSensor();
+void captureBlock();
+void readCurrentSensor();
+void readButtons();
+void processLogic();
+void writeOutputs();
+
+// Scan cycle task table (runs in table order; base rate MAGNETIC_SAMPLE_RATE_HZ, slots keyed
+// on the timer tick count). "fft" transforms the debug-stream windows; the slip window is
+// transformed inside "logic" as soon as it fills.
+HOT_DATA Scheduler::RateGroup scanTasks[] = {
+  {"magnetic", 1,                    0,                  readMagneticSensor},
+  {"current",  CURRENT_READ_DIVIDER, CURRENT_READ_PHASE, readCurrentSensor},
+  {"buttons",  BUTTON_READ_DIVIDER,  BUTTON_READ_PHASE,  readButtons},
+  {"fft",      FFT_COMPUTE_DIVIDER,  FFT_COMPUTE_PHASE,  FFTProcessor::computeDue},
+  {"logic",    1,                    0,                  processLogic},
+  {"outputs",  1,                    0,                  writeOutputs},
+  {"health",   HEALTH_CHECK_DIVIDER, HEALTH_CHECK_PHASE, TimingMonitor::evaluateWindow},
+};
 
 // Timer interrupt for sampling synchronization
 void ARDUINO_ISR_ATTR magneticSensor_ISR() {
-  portENTER_CRITICAL_ISR(&timerMux);
-  newDataAvailable = true;
-  portEXIT_CRITICAL_ISR(&timerMux);
-  xSemaphoreGiveFromISR(timerSemaphore, NULL);
+  TimingMonitor::onTimerISR();
+  BaseType_t higherPriorityTaskWoken = pdFALSE;
+#if MAGNETIC_ASYNC_ACQUISITION
+  // Start reading sample N+1; the control task processes sample N while the bus is busy
+  I2CBus::tickFromISR(&higherPriorityTaskWoken);
+#endif
+  vTaskNotifyGiveFromISR(controlTaskHandle, &higherPriorityTaskWoken);
+  // Switch straight to the woken task instead of waiting for the next tick
+  portYIELD_FROM_ISR(higherPriorityTaskWoken);
+}
+
+// Stepper configuration and homing; the scan cycle does not wait for it (lift moves
+// are ignored until the stepper exists and homing has finished)
+void liftBringUpTask(void* parameter) {
+  int phase = BootTimeline::begin("motor");
+  MotorDriver::init();
+  BootTimeline::end(phase);
+
+  // Warm start: a lift position stored at rest makes homing unnecessary
+  phase = BootTimeline::begin("lift_restore");
+  bool restored = MotorDriver::restorePosition();
+  BootTimeline::end(phase);
+
+  if (!restored) {
+    phase = BootTimeline::begin("homing");
+    MotorDriver::runHomingRoutine();
+    BootTimeline::end(phase);
+  }
+  vTaskDelete(NULL);
 }
 
 void setup() {
@@ -48,103 +110,226 @@ void setup() {
   
   Serial.println("\n--- ADAPTIVE GRIPPING SYSTEM ---");
   
+  // Lift bring-up (UART config + homing) runs on Core 0 while the sensors come up here
+  if (xTaskCreatePinnedToCore(liftBringUpTask, "LiftBringUp", HOMING_TASK_STACK_SIZE,
+                              NULL, HOMING_TASK_PRIORITY, NULL, HOMING_TASK_CORE) != pdPASS) {
+    Serial.println("Error: Failed to create lift bring-up task");
+    while (1) delay(1000);
+  }
+
   // Hardware initialization
+  int phase = BootTimeline::begin("servo");
   ServoDriver::init();
+  BootTimeline::end(phase);
+
+  phase = BootTimeline::begin("magnetic");
   if (!MagneticSensor::init()) {
     Serial.println("Error: Magnetic sensor init failed");
     while (1) delay(1000);
   }
+  BootTimeline::end(phase);
 
+  phase = BootTimeline::begin("current");
   if (!CurrentSensor::init()) {
     Serial.println("Error: Current sensor init failed");
     while (1) delay(1000);
   }
+  BootTimeline::end(phase);
   
+  phase = BootTimeline::begin("buttons");
   Buttons::init();
-  MotorDriver::init();
-  
-  Serial.println("Homing Z-axis...");
-  MotorDriver::runHomingRoutine();
-  Serial.println("Homing complete.");
+  BootTimeline::end(phase);
   
+  phase = BootTimeline::begin("calibration");
+  OnlineCalibration::init(calData);
+  controlState.calibrated = calData.valid;
+  BootTimeline::end(phase);
+
+  phase = BootTimeline::begin("dsp");
   Filters::init();
-  MagneticSensor::calibrate(calData);
+  FFTChannels::init();
+  SignalGraph::printSchedule();
+  BootTimeline::end(phase);
+
+  phase = BootTimeline::begin("read_bench");
+  MagneticSensor::benchmarkReadPaths();
+  BootTimeline::end(phase);
   
+  phase = BootTimeline::begin("tasks");
+  TimingMonitor::init();
+  Scheduler::init(scanTasks, sizeof(scanTasks) / sizeof(scanTasks[0]));
+  DebugTask::init();
+  Experiment::init();
+
+  // Control cycle runs in its own task on Core 1, woken by the timer ISR
+  if (CONTROL_TASK_DEDICATED) {
+    xTaskCreatePinnedToCore(
+      controlTaskFunction,
+      "ControlTask",
+      CONTROL_TASK_STACK_SIZE,
+      NULL,
+      CONTROL_TASK_PRIORITY,
+      &controlTaskHandle,
+      CONTROL_TASK_CORE
+    );
+    if (controlTaskHandle == NULL) {
+      Serial.println("Error: Failed to create control task");
+      while (1) delay(1000);
+    }
+  } else {
+    controlTaskHandle = xTaskGetCurrentTaskHandle();
+  }
+
+#if MAGNETIC_ASYNC_ACQUISITION
+  if (!I2CBus::start()) {
+    while (1) delay(1000);
+  }
+#else
+  Serial.println("[I2C] WARNING: synchronous reads, no bus hang detection or recovery");
+#endif
+
   // Configure timer for determinstic loop
-  timerSemaphore = xSemaphoreCreateBinary();
   timer = timerBegin(1000000);
   timerAttachInterrupt(timer, &magneticSensor_ISR);
   timerAlarm(timer, SCAN_INTERVAL_US, true, 0); 
-
-  DebugTask::init();
+  BootTimeline::end(phase);
   
-  Serial.flush();
-  delay(500);
-  Serial.println("System Ready.");
+  BootTimeline::markReady();
+  Serial.printf("System Ready (%lu ms).\n", millis());
 }
 
-void readInputsSequentially() {
-  // High priority: Magnetic sensor (2kHz)
-  double raw_x=0, raw_y=0, raw_z=0;
-  MagneticSensor::read(raw_x, raw_y, raw_z);
+void HOT_PATH readMagneticSensor() {
+  // Bus hung or recovering: keep the last filtered state instead of feeding stale samples
+  if (!I2CBus::isHealthy()) return;
+  
+  float raw_x=0, raw_y=0, raw_z=0;
+  uint32_t sample_time_us = 0;
+  // No new conversion since the last cycle: a repeated sample would enter the filters
+  // and the FFT window as if it were new, so keep the last filtered state instead
+  if (!MagneticSensor::acquire(raw_x, raw_y, raw_z, sample_time_us)) return;
+  
+  float* raw = magBlockRaw[magBlockFill];
+  raw[0] = raw_x;
+  raw[1] = raw_y;
+  raw[2] = raw_z;
+  
+  // Zero tracking runs on raw counts between samples, so the swap is never seen mid-sample
+  OnlineCalibration::update(raw_x, raw_y, raw_z, controlState, !MotorDriver::isMoving(), calData);
+  controlState.calibrated = calData.valid;
   MagneticSensor::applyCalibration(raw_x, raw_y, raw_z, calData);
   
-  magData.x = raw_x;
-  magData.y = raw_y;
-  magData.z = raw_z;
-  magData.magnitude = MagneticSensor::calculateMagnitude(raw_x, raw_y, raw_z);
+  MagneticData& sample = magBlock[magBlockFill++];
+  sample.timestamp_us = sample_time_us;
+  sample.x = raw_x;
+  sample.y = raw_y;
+  sample.z = raw_z;
+  if constexpr (SignalGraph::isLive(NODE_MAGNITUDE)) {
+    sample.magnitude = MagneticSensor::calculateMagnitude(raw_x, raw_y, raw_z);
+  }
+  
+  magBlockReady = (magBlockFill >= DSP_BLOCK_SIZE);
+  if (!magBlockReady) return;
+  
+  // Filter the whole block; the newest sample becomes the current state
+  Filters::applyMainFilterBlock(magBlock, DSP_BLOCK_SIZE);
+  Filters::applyBandSplitFilterBlock(magBlock, DSP_BLOCK_SIZE);
+  controlState.mag = magBlock[DSP_BLOCK_SIZE - 1];
+  magBlockFill = 0;
   
-  Filters::applyMainFilterMagneticSensor(magData);
-  Filters::applyBandSplitFilterMagneticSensor(magData);
+  captureBlock();
+}
 
-  // Low priority: Current sensing (sliced)
-  if (cycleCounter % CURRENT_READ_DIVIDER == 0) {
-      float raw_current = CurrentSensor::readCurrent_mA();
-      current_mA = Filters::filterCurrent(raw_current);
+// Hand every sample (raw and filtered) to the telemetry core (lossless full-rate capture)
+void HOT_PATH captureBlock() {
+  if (!SampleRing::isEnabled()) return;
+  
+  static uint32_t seq = 0;
+  for (uint8_t i = 0; i < DSP_BLOCK_SIZE; i++) {
+    const MagneticData& s = magBlock[i];
+    SampleRecord record;
+    record.seq = seq++;
+    record.timestamp_us = s.timestamp_us;
+    record.raw_x = magBlockRaw[i][0];
+    record.raw_y = magBlockRaw[i][1];
+    record.raw_z = magBlockRaw[i][2];
+    record.mag_x_high_pass = s.x_high_pass;
+    record.mag_y_high_pass = s.y_high_pass;
+    record.mag_z_high_pass = s.z_high_pass;
+    record.current_mA = controlState.current_mA;
+    record.servo_position = controlState.servo_position;
+    record.gripping_mode = (uint8_t)controlState.gripping_mode;
+    record.slip_flag = controlState.slip_flag ? 1 : 0;
+    SampleRing::push(record);
   }
+}
 
-  // Low priority: UI Buttons
-  if (cycleCounter % BUTTON_READ_DIVIDER == 0) {
-      buttons = Buttons::read();
-  }
+void HOT_PATH readCurrentSensor() {
+  float raw_current = CurrentSensor::acquire_mA();
+  controlState.current_mA = Filters::filterCurrent(raw_current);
+}
+
+void readButtons() {
+  controlState.buttons = Buttons::read();
 }
 
-void processLogic() {
-  FFTProcessor::process(magData);
-  SlipDetection::detect();
-  GrippingFSM::process(buttons, current_mA, magData.magnitude);
+void HOT_PATH processLogic() {
+  // While blind the FSM is frozen, so the servo holds its last commanded position
+  if (I2CBus::isHealthy()) {
+    if (magBlockReady) {
+      FFTProcessor::processBlock(magBlock, DSP_BLOCK_SIZE);
+      magBlockReady = false;
+    }
+    SlipDetection::detect(controlState);
+    GrippingFSM::process(controlState, millis());
+  }
 
   // Manual lift control
   static bool lastBtn3 = false, lastBtn4 = false, lastBtn5 = false;
   
-  if (buttons.button_3 && !lastBtn3) {
-      MotorDriver::moveToMM(150);
+  if (controlState.buttons.button_3 && !lastBtn3) {
+      MotorDriver::moveToMM(LIFT_TRAVEL_MM);
   }
-  lastBtn3 = buttons.button_3;
+  lastBtn3 = controlState.buttons.button_3;
  
-  if (buttons.button_4 && !lastBtn4) {
+  if (controlState.buttons.button_4 && !lastBtn4) {
       MotorDriver::moveToMM(0);
   }
-  lastBtn4 = buttons.button_4;
+  lastBtn4 = controlState.buttons.button_4;
   
-  if (buttons.button_5 && !lastBtn5) {
+  if (controlState.buttons.button_5 && !lastBtn5) {
       MotorDriver::setTargetSpeed(0);
   }
-  lastBtn5 = buttons.button_5;
+  lastBtn5 = controlState.buttons.button_5;
+}
+
+void HOT_PATH writeOutputs() {
+  ServoDriver::writePositionIfChanged(controlState.servo_position);
 }
 
-void writeOutputs() {
-  ServoDriver::writePositionIfChanged(servo_position);
+void HOT_PATH runScanCycle() {
+  TimingMonitor::onCycleStart();
+  Scheduler::run(TimingMonitor::lastTick());
+  TimingMonitor::onCycleEnd();
+  cycleCounter++;
+  DebugTask::updateData(controlState);
+}
+
+void controlTaskFunction(void* parameter) {
+  for (;;) {
+    // Wait for timer trigger to start cycle
+    if (ulTaskNotifyTake(pdTRUE, portMAX_DELAY) > 0) {
+      runScanCycle();
+    }
+  }
 }
 
 void loop() {
-  // Wait for timer trigger to start cycle
-  if (xSemaphoreTake(timerSemaphore, portMAX_DELAY) == pdTRUE) {
-    readInputsSequentially();
-    processLogic();
-    writeOutputs();
-
-    cycleCounter++;
-    DebugTask::updateData();
+  if (CONTROL_TASK_DEDICATED) {
+    // Nothing left for the Arduino loop task to do
+    vTaskDelete(NULL);
+  }
+
+  if (ulTaskNotifyTake(pdTRUE, portMAX_DELAY) > 0) {
+    runScanCycle();
   }
 }
@@ -26,15 +26,136 @@ constexpr int SERVO_FULLY_CLOSED = 0;
 // ============================================
 // TIMING CONFIGURATION
 // ============================================
-constexpr unsigned long SCAN_INTERVAL_US = 500;  // 500us scan cycle (2kHz)
+// Single rate constant: scan period, filter coefficients, FFT bins and task dividers derive from it.
+// TLV493D fast mode converts at ~3.3 kHz, so rates above that only repeat conversions.
+constexpr uint32_t MAGNETIC_SAMPLE_RATE_HZ = 2000;
+constexpr unsigned long SCAN_INTERVAL_US = 1000000UL / MAGNETIC_SAMPLE_RATE_HZ;  // 500us at 2 kHz
 constexpr unsigned long CURRENT_READ_INTERVAL_MS = 10; // 10ms (100Hz)
 constexpr unsigned long BUTTON_READ_INTERVAL_MS = 50;  // 50ms (20Hz) for button debounce/polling
+constexpr unsigned long HEALTH_CHECK_INTERVAL_MS = 1000; // 1s (1Hz) timing/fault supervision
+
+// ============================================
+// SCHEDULER CONFIGURATION
+// ============================================
+// Dividers of the scan rate; phases spread the slow tasks over different ticks
+// Scan cycles covering a duration (rounded, at least one)
+constexpr uint32_t msToCycles(unsigned long ms) {
+  return (ms * 1000UL + SCAN_INTERVAL_US / 2) / SCAN_INTERVAL_US > 0 ? (ms * 1000UL + SCAN_INTERVAL_US / 2) / SCAN_INTERVAL_US : 1;
+}
+constexpr uint32_t CURRENT_READ_DIVIDER = msToCycles(CURRENT_READ_INTERVAL_MS);  // ~100Hz
+constexpr uint32_t BUTTON_READ_DIVIDER = msToCycles(BUTTON_READ_INTERVAL_MS);    // ~20Hz
+constexpr uint32_t HEALTH_CHECK_DIVIDER = msToCycles(HEALTH_CHECK_INTERVAL_MS);  // ~1Hz
+constexpr uint32_t CURRENT_READ_PHASE = 5;
+constexpr uint32_t BUTTON_READ_PHASE = 12;
+constexpr uint32_t HEALTH_CHECK_PHASE = 17;
+static_assert(CURRENT_READ_PHASE < CURRENT_READ_DIVIDER && BUTTON_READ_PHASE < BUTTON_READ_DIVIDER &&
+              HEALTH_CHECK_PHASE < HEALTH_CHECK_DIVIDER, "Scheduler phase must be below its divider at this rate");
 
 // ============================================
 // SAMPLING AND FFT CONFIGURATION
 // ============================================
 constexpr uint16_t FFT_SAMPLES = 128;  // Must be power of 2
-constexpr double MAGNETIC_SENSOR_SAMPLING_FREQUENCY = 1000000.0 / (double)SCAN_INTERVAL_US;
+constexpr double MAGNETIC_SENSOR_SAMPLING_FREQUENCY = 1000000.0 / (double)SCAN_INTERVAL_US;  // Achieved rate
+constexpr double FFT_BIN_HZ = MAGNETIC_SENSOR_SAMPLING_FREQUENCY / FFT_SAMPLES;
+constexpr double NYQUIST_HZ = MAGNETIC_SENSOR_SAMPLING_FREQUENCY / 2.0;
+// The slip channel is transformed in the push path the moment its window fills (slip detection
+// frees it in the same tick, so its windows stay contiguous). The other live channels (debug
+// stream) only need a spectrum now and then; they are transformed in this slot so their CPU
+// cost never lands on the slip tick. Phase 2 never meets the current (5 mod 4), button (12 mod 4)
+// or health (17 mod 16) slots; Scheduler::init() warns if a retune breaks that.
+constexpr uint32_t FFT_COMPUTE_DIVIDER = FFT_SAMPLES;
+constexpr uint32_t FFT_COMPUTE_PHASE = 2;
+static_assert(FFT_COMPUTE_PHASE < FFT_COMPUTE_DIVIDER, "FFT compute phase must be below its divider");
+
+// ============================================
+// ANALYSIS CHANNEL CONFIGURATION
+// ============================================
+// Signals that can feed an FFT channel
+enum FFTChannelSource : uint8_t {
+  FFT_SOURCE_X_HIGH_PASS,
+  FFT_SOURCE_Y_HIGH_PASS,
+  FFT_SOURCE_Z_HIGH_PASS,
+  FFT_SOURCE_MAGNITUDE_HIGH_PASS,
+  FFT_SOURCE_X_LOW_PASS,
+  FFT_SOURCE_Y_LOW_PASS,
+  FFT_SOURCE_Z_LOW_PASS,
+  FFT_SOURCE_MAGNITUDE_LOW_PASS
+};
+
+struct FFTChannelConfig {
+  const char* name;
+  FFTChannelSource source;
+};
+
+// Only channels listed here get buffers (carved from one static arena)
+constexpr FFTChannelConfig FFT_CHANNELS[] = {
+  {"X_high_pass", FFT_SOURCE_X_HIGH_PASS},
+  {"Y_high_pass", FFT_SOURCE_Y_HIGH_PASS},
+};
+constexpr size_t FFT_CHANNEL_COUNT = sizeof(FFT_CHANNELS) / sizeof(FFT_CHANNELS[0]);
+
+// Index of the channel fed by source, -1 if not declared
+constexpr int fftChannelIndex(FFTChannelSource source, size_t i = 0) {
+  return i >= FFT_CHANNEL_COUNT ? -1 : (FFT_CHANNELS[i].source == source ? (int)i : fftChannelIndex(source, i + 1));
+}
+
+constexpr FFTChannelSource SLIP_DETECTION_SOURCE = FFT_SOURCE_Y_HIGH_PASS;
+constexpr FFTChannelSource FFT_STREAM_SOURCE = FFT_SOURCE_X_HIGH_PASS;  // {"fft":true} output
+constexpr int SLIP_FFT_CHANNEL = fftChannelIndex(SLIP_DETECTION_SOURCE);
+constexpr int STREAM_FFT_CHANNEL = fftChannelIndex(FFT_STREAM_SOURCE);
+static_assert(SLIP_FFT_CHANNEL >= 0, "SLIP_DETECTION_SOURCE must be declared in FFT_CHANNELS");
+static_assert(STREAM_FFT_CHANNEL >= 0, "FFT_STREAM_SOURCE must be declared in FFT_CHANNELS");
+static_assert(SLIP_FFT_CHANNEL < (int)FFT_CHANNEL_COUNT && STREAM_FFT_CHANNEL < (int)FFT_CHANNEL_COUNT,
+              "FFT channel index out of range");
+// Slip detection and the debug stream each clear FFT_complete on their own channel
+static_assert(SLIP_FFT_CHANNEL != STREAM_FFT_CHANNEL, "Slip and stream FFT channels must be distinct");
+
+// True if no source is declared twice (lookups would silently use the first entry)
+constexpr bool fftChannelsUnique(size_t i = 0) {
+  return i >= FFT_CHANNEL_COUNT || (fftChannelIndex(FFT_CHANNELS[i].source) == (int)i && fftChannelsUnique(i + 1));
+}
+static_assert(fftChannelsUnique(), "FFT_CHANNELS declares a source twice");
+
+// ============================================
+// SIGNAL FLOW CONFIGURATION
+// ============================================
+// Stages of the acquisition -> filter -> analysis pipeline (edges in Logic/SignalGraph.h).
+// A stage is computed only if some sink (FSM, telemetry) depends on it.
+enum SignalNode : uint8_t {
+  NODE_MAG_SOURCE,         // Calibrated TLV493D sample
+  NODE_MAGNITUDE,          // |B| of the calibrated sample
+  NODE_MAIN_LP_X,          // 500 Hz low-pass
+  NODE_MAIN_LP_Y,
+  NODE_MAIN_LP_Z,
+  NODE_MAIN_LP_MAGNITUDE,
+  NODE_LOW_PASS_X,         // 30 Hz band-split low-pass
+  NODE_LOW_PASS_Y,
+  NODE_LOW_PASS_Z,
+  NODE_LOW_PASS_MAGNITUDE,
+  NODE_HIGH_PASS_X,        // Band-split high-pass (main - low)
+  NODE_HIGH_PASS_Y,
+  NODE_HIGH_PASS_Z,
+  NODE_HIGH_PASS_MAGNITUDE,
+  NODE_SLIP_SPECTRUM,      // FFT channel of SLIP_DETECTION_SOURCE
+  NODE_STREAM_SPECTRUM,    // FFT channel of FFT_STREAM_SOURCE
+  NODE_SLIP_DETECTOR,
+  NODE_GRIP_FSM,           // Sink
+  NODE_TELEMETRY,          // Sink
+  NODE_COUNT
+};
+
+// Signals the telemetry streams (JSON + capture ring) need; drop entries to stop computing them
+constexpr SignalNode TELEMETRY_SIGNALS[] = {
+  NODE_MAIN_LP_X, NODE_MAIN_LP_Y, NODE_MAIN_LP_Z, NODE_MAIN_LP_MAGNITUDE,
+  NODE_LOW_PASS_X, NODE_LOW_PASS_Y, NODE_LOW_PASS_Z,
+  NODE_HIGH_PASS_X, NODE_HIGH_PASS_Y, NODE_HIGH_PASS_Z,
+  NODE_STREAM_SPECTRUM,
+};
+
+// FFT arena: real + imaginary buffer per declared channel
+constexpr size_t FFT_ARENA_BYTES = FFT_CHANNEL_COUNT * 2 * FFT_SAMPLES * sizeof(double);
+constexpr size_t DSP_MEMORY_BUDGET_BYTES = 8192;
+static_assert(FFT_ARENA_BYTES <= DSP_MEMORY_BUDGET_BYTES, "FFT channels exceed DSP_MEMORY_BUDGET_BYTES");
 
 // ============================================
 // FILTER CONFIGURATION
@@ -48,10 +169,19 @@ constexpr double FILTER_30HZ_CUTOFF_FREQ = 30.0;
 
 // 500 Hz low-pass filter cutoff (main filter)
 constexpr double FILTER_500HZ_CUTOFF_FREQ = 500.0;
+static_assert(FILTER_500HZ_CUTOFF_FREQ < NYQUIST_HZ, "Main filter cutoff must lie below Nyquist");
+
+// Block processing: acquisition stays at the scan rate, filtering and FFT
+// feeding run once per DSP_BLOCK_SIZE samples (1 = per-sample processing)
+constexpr uint8_t DSP_BLOCK_SIZE = 1;
+constexpr unsigned long DSP_BLOCK_LATENCY_US = (DSP_BLOCK_SIZE - 1) * SCAN_INTERVAL_US; // Added by blocking
+static_assert(DSP_BLOCK_SIZE >= 1 && DSP_BLOCK_SIZE <= 16, "DSP_BLOCK_SIZE must be 1..16");
+// The slip window is transformed at the end of a block and consumed in the same tick
+static_assert(FFT_SAMPLES % DSP_BLOCK_SIZE == 0, "FFT windows must end on a block boundary");
 
 // Current filter (5 Hz at 100 Hz sampling)
 constexpr double FILTER_CURRENT_CUTOFF_FREQ = 5.0;
-constexpr double FILTER_CURRENT_SAMPLE_RATE = 100.0;
+constexpr double FILTER_CURRENT_SAMPLE_RATE = 1000.0 / CURRENT_READ_INTERVAL_MS;
 
 
 // ============================================
@@ -60,8 +190,39 @@ constexpr double FILTER_CURRENT_SAMPLE_RATE = 100.0;
 constexpr float SLIP_THRESHOLD =30.0f;
 constexpr uint16_t SLIP_FREQ_START_HZ = 60;
 constexpr uint16_t SLIP_FREQ_END_HZ = 125;
-constexpr int SLIP_DETECTION_IGNORE_CYCLES = 100; // Ignore slip for 50 cycles (25ms) after movement to filter vibration
+constexpr unsigned long SLIP_DETECTION_IGNORE_MS = 50; // Ignore slip after movement to filter vibration
+constexpr int SLIP_DETECTION_IGNORE_CYCLES = msToCycles(SLIP_DETECTION_IGNORE_MS);
+
+// FFT bins of the slip band (rounded to the nearest bin at the configured rate)
+constexpr uint16_t SLIP_START_BIN = (uint16_t)(SLIP_FREQ_START_HZ / FFT_BIN_HZ + 0.5);
+constexpr uint16_t SLIP_END_BIN = (uint16_t)(SLIP_FREQ_END_HZ / FFT_BIN_HZ + 0.5);
+static_assert(SLIP_FREQ_END_HZ < NYQUIST_HZ, "Slip band must lie below Nyquist");
+static_assert(SLIP_END_BIN <= FFT_SAMPLES / 2, "Slip band exceeds the FFT spectrum");
+static_assert(SLIP_END_BIN >= SLIP_START_BIN + 2, "Slip band must span at least two FFT bins at this rate");
 constexpr float GRIP_SLIP_MARGIN_FALSE_POSITIVE=2.5f;
+// ============================================
+// ONLINE CALIBRATION
+// ============================================
+// Zero is learned from raw samples while OPEN and the lift is idle
+constexpr uint32_t CALIB_WINDOW_SAMPLES = MAGNETIC_SAMPLE_RATE_HZ;  // 1 s windows
+// TLV493D noise is ~0.1 mT rms (one 0.098 mT LSB) at rest, so a quiet window already sits near
+// 0.01 mT^2. The limit allows 2 LSB std; a grasp or lift bump moves the field by whole mT.
+constexpr float CALIB_STILL_VARIANCE_MT2 = 0.04f;  // Max per-axis variance (0.2 mT std) of a usable window
+// Without any zero the FSM refuses to grasp. After this many rejected windows in a row the
+// quietest one is accepted (reported as "fallback"), so a noisy rig is not locked out.
+constexpr uint32_t CALIB_FALLBACK_WINDOWS = 10;
+constexpr float CALIB_DRIFT_GAIN = 0.25f;          // Blend of each later window into the zero
+// Cross-axis correction matrix, fitted on host (software/fit_calibration.py), kept in NVS
+#define CALIB_NVS_NAMESPACE "calib"
+// Sanity limits for a received/stored matrix (a fitted one is near identity: unit diagonal,
+// off-diagonal leakage terms well below 1)
+constexpr float CALIB_MATRIX_MAX_GAIN = 4.0f;   // Largest |entry|
+constexpr float CALIB_MATRIX_MIN_DET = 0.1f;    // Smallest |determinant| (near-singular otherwise)
+// The learned zero is also kept in NVS so a reboot can grasp before the first still window
+constexpr uint32_t CALIB_SAVE_INTERVAL_MS = 60000;  // Min time between zero writes (flash wear)
+constexpr float CALIB_SAVE_DELTA_MT = 0.05f;        // Zero change that is worth a write
+constexpr uint32_t CALIB_COST_BENCH_SAMPLES = 1000;  // applyCalibration calls timed for the report
+
 // ============================================
 // GRIPPING STATE MACHINE TIMING
 // ============================================
@@ -83,6 +244,79 @@ constexpr int GRASPING_STEP = 1;
 constexpr int OPENING_STEP = 5;
 constexpr int BACKOFF_STEP = 1;
 constexpr int MAX_REACTION_STEPS = 4;
+// ============================================
+// CONTROL TASK CONFIGURATION
+// ============================================
+// When false the scan cycle runs in the Arduino loop() task instead (for A/B latency comparison)
+constexpr bool CONTROL_TASK_DEDICATED = true;
+constexpr uint32_t CONTROL_TASK_STACK_SIZE = 8192;
+constexpr UBaseType_t CONTROL_TASK_PRIORITY = 10; // Above every other application task
+constexpr BaseType_t CONTROL_TASK_CORE = 1;
+
+// ============================================
+// I2C BUS TASK (ASYNC ACQUISITION)
+// ============================================
+// When true the timer ISR wakes a higher-priority I2C bus task next to the control task.
+// This is a task handoff, not a non-blocking driver read with a completion callback:
+// the bus task makes the ordinary blocking Wire.requestFrom (the Wire driver blocks that
+// task until the I2C interrupt completes the transfer) and publishes the frame to a seqlock.
+// The control task is never notified of completion. In the same tick it takes whatever
+// sample the seqlock holds, i.e. the one read in the previous period. So a sample reaches
+// the filters one period (SCAN_INTERVAL_US) later than with a synchronous read, and the
+// control task never waits on the bus.
+// INA219 reads are queued to the same task and fitted into the rest of the slot.
+#define MAGNETIC_ASYNC_ACQUISITION true
+constexpr uint32_t I2C_BUS_TASK_STACK_SIZE = 3072;
+constexpr UBaseType_t I2C_BUS_TASK_PRIORITY = CONTROL_TASK_PRIORITY + 1;
+static_assert(!MAGNETIC_ASYNC_ACQUISITION || CONTROL_TASK_DEDICATED,
+              "Async acquisition overlaps the bus read with the dedicated control task");
+
+constexpr uint32_t I2C_SLOT_GUARD_US = SCAN_INTERVAL_US / 5;  // Bus must be idle this long before the next tick
+constexpr uint32_t I2C_SLOT_BUDGET_US = SCAN_INTERVAL_US - I2C_SLOT_GUARD_US;
+constexpr uint32_t I2C_MAGNETIC_EXPECTED_US = 100;  // Initial estimates, refined at run time
+constexpr uint32_t I2C_CURRENT_EXPECTED_US = 60;   // One 2-byte read (lean INA219 driver)
+
+// Bus health: transaction histogram and hang recovery (runs on the bus task)
+constexpr int I2C_HIST_BINS = 16;
+constexpr uint32_t I2C_HIST_BIN_US = 20;
+constexpr uint16_t I2C_TRANSACTION_TIMEOUT_MS = 2;  // Wire timeout (default 50 ms) bounds a stuck transfer
+constexpr uint32_t I2C_HANG_FAIL_LIMIT = 8;         // Consecutive failed transactions -> bus declared hung
+// TLV493D off / power-up wait for the sensor supply reset (boot and second recovery attempt).
+// Original bring-up value; keep it until the A1B6 power-up time is measured on this board.
+// Every reset is followed by a read-back of the sensor (i2c report: verify_fail).
+constexpr uint32_t I2C_SENSOR_POWER_CYCLE_MS = 100;
+
+// Hang detection, recovery and I2CBus::isHealthy() exist only on the bus task, so they
+// require MAGNETIC_ASYNC_ACQUISITION. A synchronous build is a bench mode for read-path
+// comparisons: a hung bus is never detected, isHealthy() stays true and the FSM keeps
+// running on the last good sample. Such a build must opt out explicitly with false here.
+#define I2C_HANG_RECOVERY true
+static_assert(!I2C_HANG_RECOVERY || MAGNETIC_ASYNC_ACQUISITION,
+              "Hang recovery runs on the I2C bus task: enable MAGNETIC_ASYNC_ACQUISITION "
+              "or set I2C_HANG_RECOVERY false for a synchronous bench build");
+
+// ============================================
+// HOT PATH PLACEMENT
+// ============================================
+// 1: per-cycle functions run from IRAM and their tables sit in DRAM, so a flash
+// cache miss (e.g. Core 0 streaming printf) cannot stall the scan cycle.
+// 0: everything stays in flash, for comparing exec-time histograms.
+// Only functions whose own body does the work are marked (filters, scheduler,
+// calibration apply, FFT sample push, seqlock acquire). Wire, FreeRTOS
+// semaphore, ArduinoFFT and ESP32Servo code always stays in flash, so the
+// sensor bus reads, the FFT transform and servo writes are left unmarked.
+#ifndef HOT_PATH_IN_IRAM
+#define HOT_PATH_IN_IRAM 1
+#endif
+
+#if HOT_PATH_IN_IRAM
+#define HOT_PATH IRAM_ATTR
+#define HOT_DATA DRAM_ATTR
+#else
+#define HOT_PATH
+#define HOT_DATA
+#endif
+
 // ============================================
 // DEBUG TASK CONFIGURATION
 // ============================================
@@ -90,11 +324,67 @@ constexpr unsigned long DEBUG_PRINT_INTERVAL_MS = 1;
 constexpr uint32_t DEBUG_TASK_STACK_SIZE = 8192;
 constexpr UBaseType_t DEBUG_TASK_PRIORITY = 1;
 constexpr BaseType_t DEBUG_TASK_CORE = 0;
+constexpr size_t DEBUG_CMD_BUFFER_SIZE = 192;   // Fits {"calmatrix":[...9 floats...]}
+constexpr uint32_t BOOT_TIMELINE_CAPACITY = 24;  // Init phases kept for {"boot": true}
+
+// Lossless full-rate capture ring (power of 2)
+constexpr uint32_t SAMPLE_RING_CAPACITY = 512;   // 256 ms at 2 kHz, 155 ms at 3.3 kHz
+constexpr uint8_t SAMPLE_RING_BATCH = 8;         // Records per telemetry line
+static_assert((SAMPLE_RING_CAPACITY & (SAMPLE_RING_CAPACITY - 1)) == 0, "SAMPLE_RING_CAPACITY must be a power of 2");
+
+// ============================================
+// TIMING MONITOR CONFIGURATION
+// ============================================
+constexpr uint16_t TIMING_HIST_BINS = 20;
+constexpr uint16_t TIMING_HIST_BIN_US = (SCAN_INTERVAL_US + TIMING_HIST_BINS - 1) / TIMING_HIST_BINS; // Bins cover one scan interval
+constexpr uint32_t TIMING_OVERRUN_FAULT_LIMIT = 20;       // Missed ticks + overruns per health check window (1%)
 
 // ============================================
 // I2C CONFIGURATION
 // ============================================
 constexpr uint32_t MAGNETIC_I2C_CLOCK_SPEED = 1000000;  
+
+// INA219 lean driver (configured once, then one 2-byte current read per sample)
+constexpr uint8_t INA219_I2C_ADDRESS = 0x40;
+constexpr uint8_t INA219_REG_CONFIG = 0x00;
+constexpr uint8_t INA219_REG_BUS_VOLTAGE = 0x02;  // Bit 1 = CNVR (conversion ready)
+constexpr uint8_t INA219_REG_POWER = 0x03;        // Reading it clears CNVR
+constexpr uint8_t INA219_REG_CURRENT = 0x04;
+constexpr uint8_t INA219_REG_CALIBRATION = 0x05;
+// 32 V range, /8 gain (320 mV), shunt ADC 12-bit x8 averaging (4.26 ms), shunt-only continuous
+constexpr uint16_t INA219_CONFIG = 0x2000 | 0x1800 | (0x3 << 7) | (0xB << 3) | 0x5;
+constexpr uint16_t INA219_CALIBRATION = 4096;     // 0.1 mA/LSB with the 0.1 ohm shunt
+constexpr float INA219_CURRENT_LSB_MA = 0.1f;
+// Skip samples without a new conversion (costs a status read and a power read per sample)
+#define INA219_CHECK_CONVERSION_READY false
+
+// TLV493D-A1B6 direct register access (bypasses the library on the hot path)
+#define MAGNETIC_DIRECT_READ true                 // false = tlx493d_getMagneticField (A/B comparison)
+// The bus task needs the frame counter and the interrupt-driven burst of the direct path
+static_assert(MAGNETIC_DIRECT_READ || !MAGNETIC_ASYNC_ACQUISITION,
+              "The library read path (MAGNETIC_DIRECT_READ false) requires MAGNETIC_ASYNC_ACQUISITION false "
+              "(and therefore I2C_HANG_RECOVERY false)");
+constexpr uint8_t MAGNETIC_I2C_ADDRESS = 0x5E;    // 7-bit address selected by TLx493D_IIC_ADDR_A0_e
+constexpr uint8_t TLV493D_BURST_BYTES = 6;        // Registers 0-5: Bx, By, Bz, temp/frame, Bx/By low, Bz low
+constexpr uint8_t TLV493D_LIBRARY_READ_BYTES = 10; // Library reads the full read register map
+constexpr float TLV493D_MT_PER_LSB = 0.098f;
+constexpr int MAGNETIC_READ_BENCH_SAMPLES = 200;  // Boot-time comparison of both read paths
+
+// Rate budget: the magnetic burst (address + data bytes, 9 clocks each) plus the slot guard
+// must fit one scan period, and the sensor must convert at least as fast as we sample
+constexpr uint32_t MAGNETIC_READ_MIN_US = (uint32_t)((1 + TLV493D_BURST_BYTES) * 9 * 1000000ULL / MAGNETIC_I2C_CLOCK_SPEED) + 1;
+constexpr uint32_t TLV493D_FAST_MODE_RATE_HZ = 3300;
+static_assert(MAGNETIC_READ_MIN_US + I2C_SLOT_GUARD_US <= SCAN_INTERVAL_US,
+              "Magnetic read and bus guard do not fit the scan period at this sample rate");
+static_assert(MAGNETIC_SAMPLE_RATE_HZ <= TLV493D_FAST_MODE_RATE_HZ,
+              "Sample rate above the TLV493D fast-mode conversion rate");
+
+// Per-sample timing. The sensor converts on its own clock (FRM counts conversions, 2 bits),
+// so a read can return the previous conversion again (duplicate) or miss some (skipped).
+// With MAGNETIC_RESAMPLE the samples are linearly interpolated onto the scan grid
+// using their cycle-counter timestamps before filtering/FFT (adds up to one period of delay).
+#define MAGNETIC_RESAMPLE false
+constexpr uint8_t TLV493D_FRAME_MODULO = 4;
 // ============================================
 // TMC2209 MOTOR CONFIGURATION
 // ============================================
@@ -103,6 +393,10 @@ constexpr int TMC_TX_PIN = 17;    // Connect to RX via 1k Resistor
 constexpr int TMC_EN_PIN = 18;    // Enable pin
 constexpr int TMC_STEP_PIN = 16;
 constexpr int TMC_DIR_PIN = 15;
+// TMC2209 DIAG (high on stall). No-connect on the current PCB: wire it to a free
+// input (e.g. GPIO 34) and set it here. -1 = poll SG_RESULT over UART while homing.
+constexpr int TMC_DIAG_PIN = -1;
+static_assert(TMC_EN_PIN < 32, "The DIAG ISR drives EN through GPIO.out_w1ts (pins 0-31)");
 constexpr float TMC_R_SENSE = 0.11f;
 constexpr uint8_t TMC_DRIVER_ADDR = 0b00;
 constexpr int TMC_STALL_VALUE = 3; // Stall Sensitivity (0-255)
@@ -114,6 +408,14 @@ constexpr int TMC_MICROSTEPS = 16;
 constexpr int TMC_MAX_SPEED = 6000;      // Steps per second
 constexpr int TMC_ACCELERATION = 5000;   // Steps per second^2
 
+// UART access: settings are shadowed and flushed by a low-priority task, SG_RESULT is cached
+constexpr uint32_t TMC_LOAD_REFRESH_MS = 10;        // SG_RESULT refresh while moving
+constexpr uint32_t TMC_LOAD_IDLE_REFRESH_MS = 500;  // ... and while idle
+constexpr uint32_t TMC_CONFIG_APPLY_TIMEOUT_MS = 100;
+constexpr uint32_t TMC_UART_TASK_STACK_SIZE = 3072;
+constexpr UBaseType_t TMC_UART_TASK_PRIORITY = 1;
+constexpr BaseType_t TMC_UART_TASK_CORE = 0;
+
 // Automatic Homing Configuration
 constexpr int TMC_HOMING_CURRENT = 500;    // mA
 constexpr int TMC_HOMING_SPEED = 5000;    // Steps per second
@@ -121,7 +423,55 @@ constexpr int TMC_HOMING_THRESHOLD = 3;   // StallGuard threshold for homing
 constexpr int TMC_HOMING_CONSECUTIVE_STALLS = 3; // Number of consecutive stalls to confirm stall
 constexpr int TMC_HOMING_DIRECTION = -1;    // 1 for forward/up, -1 for backward/down
 constexpr int TMC_HOMING_TIMEOUT_MS = 1000000; // Safety timeout
+constexpr float TMC_HOMING_BACKOFF_MM = 3.0f;     // Move away from the stop first (room for the ramp)
+// Stall detection is blanked while accelerating: until homing speed is reached, plus a margin
+constexpr uint32_t TMC_HOMING_RAMP_MS = 1000UL * TMC_HOMING_SPEED / TMC_ACCELERATION;
+constexpr uint32_t TMC_HOMING_BLANK_MARGIN_MS = 20;
+// Lift position is stored in NVS when the lift is at rest and invalidated when it starts moving;
+// boot skips homing while the stored position is valid. A flash write stalls the cache of both
+// cores (the scan cycle loses ticks, see "flash" in the timing report), so writes wait for the
+// gripper to be OPEN: the position is invalidated when a grasp starts, before any lift of a held
+// object, and stored again once the lift has rested LIFT_SAVE_SETTLE_MS with the gripper OPEN.
+#define LIFT_NVS_NAMESPACE "lift"
+constexpr uint32_t LIFT_SAVE_SETTLE_MS = 2000;
+// Boot bring-up and re-homing run in a task on the core opposite to the sensor init
+constexpr uint32_t HOMING_TASK_STACK_SIZE = 4096;
+constexpr UBaseType_t HOMING_TASK_PRIORITY = 1;
+constexpr BaseType_t HOMING_TASK_CORE = 0;
 
 constexpr float TMC_STEPS_PER_MM = 2560.0f; // https://blog.prusa3d.com/calculator_3416/#MotorStuffSPML 1.8deg motor m8 metric screw
+static_assert((float)TMC_HOMING_SPEED * TMC_HOMING_SPEED / (2.0f * TMC_ACCELERATION) < TMC_HOMING_BACKOFF_MM * TMC_STEPS_PER_MM,
+              "Back-off must be longer than the homing ramp");
+
+// Lift motion profiles: queued segments executed by the motion task (not the control loop).
+// Jerk is limited only when starting from or stopping at standstill (FastAccelStepper's
+// linear acceleration phase); the accel <-> cruise transitions still step the acceleration.
+constexpr float LIFT_MAX_SPEED_MM_S = TMC_MAX_SPEED / TMC_STEPS_PER_MM;       // ~2.34 mm/s
+constexpr float LIFT_MAX_ACCEL_MM_S2 = 4.0f * TMC_ACCELERATION / TMC_STEPS_PER_MM;
+constexpr float LIFT_DEFAULT_ACCEL_MM_S2 = TMC_ACCELERATION / TMC_STEPS_PER_MM;
+constexpr float LIFT_DEFAULT_START_STOP_JERK_MM_S3 = 5.0f;  // 0 = plain trapezoid
+constexpr float LIFT_TRAVEL_MM = 150.0f;          // Top of the travel above the homed zero
+constexpr uint8_t MOTION_QUEUE_LENGTH = 16;
+constexpr uint32_t MOTION_TASK_STACK_SIZE = 3072;
+constexpr UBaseType_t MOTION_TASK_PRIORITY = 2;
+constexpr BaseType_t MOTION_TASK_CORE = 0;
+
+// ============================================
+// EXPERIMENT ENGINE
+// ============================================
+// Script steps: G grasp, W wait for HOLDING, L<mm>[@<mm/s>] lift move, H<s> hold, O open
+#define EXP_DEFAULT_SCRIPT "G,W,L50@2,H5,L0@2,O"
+constexpr uint8_t EXP_MAX_STEPS = 16;
+constexpr size_t EXP_SCRIPT_MAX_LEN = 96;
+constexpr uint32_t EXP_POLL_MS = 5;                  // State sampling period of the engine
+constexpr uint32_t EXP_STEP_TIMEOUT_MS = 15000;      // Grasp / open / wait for HOLDING
+constexpr uint32_t EXP_LIFT_TIMEOUT_MARGIN_MS = 5000; // Added to distance / speed
+constexpr uint32_t EXP_SETTLE_MS = 2000;             // OPEN and still between trials
+constexpr float EXP_MAX_HOLD_S = 3600.0f;            // Longest H step
+constexpr uint8_t EXP_MAX_CONSECUTIVE_FAILURES = 3;  // Batch stops after this many failed trials in a row
+constexpr uint8_t EXP_RECORD_QUEUE_LENGTH = 8;       // Trial records waiting for the debug task
+constexpr uint32_t EXPERIMENT_TASK_STACK_SIZE = 4096;
+constexpr UBaseType_t EXPERIMENT_TASK_PRIORITY = 1;
+constexpr BaseType_t EXPERIMENT_TASK_CORE = 0;
 
 #endif // CONFIG_H
@@ -1,6 +1,9 @@
 #include "Buttons.h"
+#include <atomic>
 
 namespace Buttons {
+
+  static std::atomic<uint8_t> virtualMask(0);
   
   void init() {
     pinMode(BUTTON_1_PIN, INPUT_PULLUP);
@@ -18,7 +21,15 @@ namespace Buttons {
     state.button_3 = !digitalRead(BUTTON_3_PIN);
     state.button_4 = !digitalRead(BUTTON_4_PIN);
     state.button_5 = !digitalRead(BUTTON_5_PIN);
+
+    uint8_t mask = virtualMask.load(std::memory_order_relaxed);
+    state.button_1 |= (mask & MASK_GRASP) != 0;
+    state.button_2 |= (mask & MASK_OPEN) != 0;
     return state;
   }
+
+  void setVirtual(uint8_t mask) {
+    virtualMask.store(mask, std::memory_order_relaxed);
+  }
 }
 
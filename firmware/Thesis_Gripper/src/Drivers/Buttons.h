@@ -10,11 +10,18 @@
 // ============================================
 
 namespace Buttons {
+  // Virtual button bits (bit i = button_(i+1))
+  constexpr uint8_t MASK_GRASP = 1 << 0;
+  constexpr uint8_t MASK_OPEN = 1 << 1;
+
   // Initialize button pins
   void init();
   
-  // Read button states
+  // Read button states (physical buttons ORed with the virtual presses)
   ButtonState read();
+
+  // Hold virtual presses until changed (experiment engine; any task)
+  void setVirtual(uint8_t mask);
 }
 
 #endif // BUTTONS_H
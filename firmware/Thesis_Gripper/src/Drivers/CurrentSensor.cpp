@@ -1,18 +1,80 @@
 #include "CurrentSensor.h"
 #include "../Globals.h"
+#include "I2CBus.h"
 #include <Arduino.h>
+#include <atomic>
 
 namespace CurrentSensor {
   
-  // Static sensor instance
-  static Adafruit_INA219 ina219;
+  // Register the INA219 pointer currently selects (reads without a pointer write use it)
+  static uint8_t pointer = 0xFF;
+  
+  // Written by the I2C bus task, read by the control task
+  static std::atomic<int16_t> latestCounts{0};
+  
+  static I2CResult writeRegister(uint8_t reg, uint16_t value) {
+    Wire.beginTransmission(INA219_I2C_ADDRESS);
+    Wire.write(reg);
+    Wire.write((uint8_t)(value >> 8));
+    Wire.write((uint8_t)(value & 0xFF));
+    I2CResult result = I2CBus::fromEndTransmission(Wire.endTransmission());
+    pointer = (result == I2C_OK) ? reg : 0xFF;
+    return result;
+  }
+  
+  static I2CResult readRegister(uint8_t reg, uint16_t& value) {
+    if (pointer != reg) {
+      Wire.beginTransmission(INA219_I2C_ADDRESS);
+      Wire.write(reg);
+      I2CResult result = I2CBus::fromEndTransmission(Wire.endTransmission());
+      if (result != I2C_OK) {
+        pointer = 0xFF;
+        return result;
+      }
+      pointer = reg;
+    }
+    
+    uint8_t buf[2];
+    uint32_t t0 = micros();
+    size_t received = Wire.requestFrom(INA219_I2C_ADDRESS, (size_t)2);
+    I2CResult result = I2CBus::fromRequest(received, 2, micros() - t0);
+    if (result != I2C_OK) return result;
+    if (Wire.readBytes(buf, 2) != 2) return I2C_ERROR;
+    value = ((uint16_t)buf[0] << 8) | buf[1];
+    return I2C_OK;
+  }
+  
+  static I2CResult readRawUnlocked(int16_t& counts) {
+    I2CResult result;
+#if INA219_CHECK_CONVERSION_READY
+    uint16_t bus;
+    result = readRegister(INA219_REG_BUS_VOLTAGE, bus);
+    if (result != I2C_OK) return result;
+    if ((bus & 0x0002) == 0) return I2C_BUSY;  // No new conversion; nothing wrong with the bus
+    uint16_t power;
+    readRegister(INA219_REG_POWER, power);  // Clears CNVR for the next check
+#endif
+    uint16_t value;
+    result = readRegister(INA219_REG_CURRENT, value);
+    if (result != I2C_OK) return result;
+    counts = (int16_t)value;
+    return I2C_OK;
+  }
+  
+  static bool configure() {
+    // Park the pointer on CURRENT so every later sample is a single read
+    uint16_t dummy;
+    return writeRegister(INA219_REG_CALIBRATION, INA219_CALIBRATION) == I2C_OK &&
+           writeRegister(INA219_REG_CONFIG, INA219_CONFIG) == I2C_OK &&
+           readRegister(INA219_REG_CURRENT, dummy) == I2C_OK;
+  }
   
   bool init() {
     Serial.println("[INA219] Initializing...");
     
     bool success = false;
     if (mutexI2C != NULL && xSemaphoreTake(mutexI2C, pdMS_TO_TICKS(100)) == pdTRUE) {
-        success = ina219.begin();
+        success = configure();
         xSemaphoreGive(mutexI2C);
     }
     
@@ -20,23 +82,47 @@ namespace CurrentSensor {
       Serial.println("[INA219] ✗ FAILED - Check wiring!");
       return false;
     }
-    Serial.println("[INA219] ✓ Ready");
+    Serial.printf("[INA219] ✓ Ready (config 0x%04X, cal %u, %.2f mA/LSB)\n",
+                  INA219_CONFIG, (unsigned)INA219_CALIBRATION, INA219_CURRENT_LSB_MA);
     return true;
   }
   
-  float readCurrent_mA() {
-    if (mutexI2C == NULL) return 0.0f;
+  bool reinit() {
+    pointer = 0xFF;
+    return configure();
+  }
+  
+  I2CResult readRaw(int16_t& counts) {
+    if (mutexI2C == NULL) return I2C_ERROR;
     
-    float result = 0.0f;
-    if (xSemaphoreTake(mutexI2C, pdMS_TO_TICKS(5)) == pdTRUE) {
-        result = ina219.getCurrent_mA();
+    I2CResult result = I2C_BUSY;
+    // Never wait on the bus from the control task; skip the sample if it is busy
+    if (xSemaphoreTake(mutexI2C, 0) == pdTRUE) {
+        result = readRawUnlocked(counts);
         xSemaphoreGive(mutexI2C);
     }
     return result;
   }
   
-  Adafruit_INA219& getSensor() {
-    return ina219;
+  float readCurrent_mA() {
+    int16_t counts = 0;
+    readRaw(counts);
+    return countsToMilliamps(counts);
+  }
+  
+  I2CResult serviceAcquisition() {
+    int16_t counts;
+    I2CResult result = readRaw(counts);
+    if (result == I2C_OK) latestCounts.store(counts, std::memory_order_relaxed);
+    return result;
+  }
+  
+  float HOT_PATH acquire_mA() {
+#if MAGNETIC_ASYNC_ACQUISITION
+    I2CBus::request(I2CBus::DEVICE_CURRENT);
+    return countsToMilliamps(latestCounts.load(std::memory_order_relaxed));
+#else
+    return readCurrent_mA();
+#endif
   }
 }
-
@@ -1,24 +1,38 @@
 #ifndef CURRENT_SENSOR_H
 #define CURRENT_SENSOR_H
 
-#include <Adafruit_INA219.h>
+#include <Wire.h>
 #include "../Config.h"
 #include "../Types.h"
+#include "I2CBus.h"
 
 // ============================================
 // CURRENT SENSOR DRIVER (INA219)
 // ============================================
 
 namespace CurrentSensor {
-  // Initialize the INA219 sensor
+  // Write configuration and calibration once, leave the register pointer on CURRENT
   bool init();
   
+  // Rewrite calibration/configuration after a bus recovery (caller holds the bus)
+  bool reinit();
+  
+  // Read the current register as raw counts (INA219_CURRENT_LSB_MA per count).
+  // Fails on a bus error or, with INA219_CHECK_CONVERSION_READY, if no new conversion.
+  I2CResult readRaw(int16_t& counts);
+  
   // Read current in mA (raw, unfiltered)
   float readCurrent_mA();
   
-  // Get sensor reference (for advanced usage)
-  Adafruit_INA219& getSensor();
+  // I2C bus task job: read the current and publish it for acquire()
+  I2CResult serviceAcquisition();
+  
+  // Control task side: queue a read on the bus scheduler and return the latest
+  // published value (async mode), or read the sensor directly
+  float acquire_mA();
+  
+  // Counts -> mA
+  inline float countsToMilliamps(int16_t counts) { return counts * INA219_CURRENT_LSB_MA; }
 }
 
 #endif // CURRENT_SENSOR_H
-
@@ -0,0 +1,291 @@
+#include "I2CBus.h"
+#include "MagneticSensor.h"
+#include "CurrentSensor.h"
+#include "../Globals.h"
+#include <Wire.h>
+#include <atomic>
+
+namespace I2CBus {
+
+  struct Job {
+    const char* name;
+    I2CResult (*transfer)();  // Runs on the bus task
+    uint32_t deadline_us;     // Max request -> start delay before the slot check is overridden
+    std::atomic<bool> pending;
+    uint32_t requested_us;
+    bool deferred;            // Already counted as deferred for this request
+    DeviceStats stats;
+  };
+
+  static Job jobs[DEVICE_COUNT] = {
+    {"magnetic", MagneticSensor::serviceAcquisition, SCAN_INTERVAL_US},
+    {"current",  CurrentSensor::serviceAcquisition,  CURRENT_READ_INTERVAL_MS * 1000},
+  };
+
+  static const uint32_t initialExpectedUs[DEVICE_COUNT] = {
+    I2C_MAGNETIC_EXPECTED_US,
+    I2C_CURRENT_EXPECTED_US,
+  };
+
+  static TaskHandle_t busTaskHandle = NULL;
+  static volatile bool resetRequested = false;
+
+  // Hang detection and recovery (bus task only, except `healthy`)
+  static std::atomic<bool> healthy{true};
+  static RecoveryStats recovery = {0};
+  static uint32_t consecutiveFailures = 0;
+  static uint32_t failedRecoveries = 0;
+  static uint32_t blindStart_us = 0;
+
+  I2CResult fromEndTransmission(uint8_t code) {
+    switch (code) {
+      case 0: return I2C_OK;
+      case 2:
+      case 3: return I2C_NACK;
+      case 5: return I2C_TIMEOUT;
+      default: return I2C_ERROR;
+    }
+  }
+
+  I2CResult fromRequest(size_t received, size_t wanted, uint32_t elapsed_us) {
+    if (received == wanted) return I2C_OK;
+    return elapsed_us >= I2C_TRANSACTION_TIMEOUT_MS * 1000 * 9 / 10 ? I2C_TIMEOUT : I2C_NACK;
+  }
+
+  static void clearStats() {
+    for (int d = 0; d < DEVICE_COUNT; d++) {
+      uint32_t expected = jobs[d].stats.expected_us;
+      memset(&jobs[d].stats, 0, sizeof(DeviceStats));
+      jobs[d].stats.expected_us = expected;
+    }
+    memset(&recovery, 0, sizeof(recovery));
+  }
+
+  static I2CResult runJob(Job& job) {
+    uint32_t t0 = micros();
+    I2CResult result = job.transfer();
+    uint32_t now = micros();
+    uint32_t dt = now - t0;
+
+    DeviceStats& s = job.stats;
+    s.transactions++;
+    switch (result) {
+      case I2C_OK: break;
+      case I2C_NACK: s.nacks++; s.failures++; break;
+      case I2C_TIMEOUT: s.timeouts++; s.failures++; break;
+      case I2C_BUSY: s.busy++; s.failures++; break;
+      default: s.failures++; break;
+    }
+    s.last_us = dt;
+    if (dt > s.max_us) s.max_us = dt;
+    uint32_t bin = dt / I2C_HIST_BIN_US;
+    if (bin < I2C_HIST_BINS) {
+      s.hist[bin]++;
+    } else {
+      s.hist_overflow++;
+    }
+
+    // Only clean transactions update the estimate and the latency figures
+    if (result == I2C_OK) {
+      // Slow-moving estimate (1/8 weight) so one outlier does not close the slot for good
+      s.expected_us = s.expected_us + ((int32_t)(dt - s.expected_us) >> 3);
+      uint32_t latency = now - job.requested_us;
+      s.latency_last_us = latency;
+      if (latency > s.latency_max_us) s.latency_max_us = latency;
+    }
+
+    job.deferred = false;
+    return result;
+  }
+
+  // Release a slave holding SDA low: up to 9 SCL pulses, then a STOP
+  static void clockOutBus() {
+    Wire.end();
+    pinMode(SDA_PIN, INPUT_PULLUP);
+    pinMode(SCL_PIN, OUTPUT_OPEN_DRAIN);
+    digitalWrite(SCL_PIN, HIGH);
+    for (int i = 0; i < 9 && digitalRead(SDA_PIN) == LOW; i++) {
+      digitalWrite(SCL_PIN, LOW);
+      delayMicroseconds(5);
+      digitalWrite(SCL_PIN, HIGH);
+      delayMicroseconds(5);
+    }
+    pinMode(SDA_PIN, OUTPUT_OPEN_DRAIN);
+    digitalWrite(SDA_PIN, LOW);
+    delayMicroseconds(5);
+    digitalWrite(SDA_PIN, HIGH);
+    delayMicroseconds(5);
+
+    Wire.begin(SDA_PIN, SCL_PIN);
+    Wire.setClock(MAGNETIC_I2C_CLOCK_SPEED);
+    Wire.setTimeOut(I2C_TRANSACTION_TIMEOUT_MS);
+  }
+
+  // Bounded: a few µs of clocking, the sensor power reset (I2C_SENSOR_POWER_CYCLE_MS x2)
+  // and a handful of configuration writes, each capped by the Wire timeout
+  static void recoverBus() {
+    uint32_t t0 = micros();
+    if (xSemaphoreTake(mutexI2C, pdMS_TO_TICKS(I2C_TRANSACTION_TIMEOUT_MS)) != pdTRUE) return;
+
+    clockOutBus();
+    bool powerCycle = failedRecoveries > 0;
+    bool verified = MagneticSensor::reinit(powerCycle);
+    CurrentSensor::reinit();
+
+    xSemaphoreGive(mutexI2C);
+
+    recovery.recoveries++;
+    if (powerCycle) recovery.power_cycles++;
+    if (!verified) recovery.verify_fails++;
+    recovery.recovery_last_us = micros() - t0;
+    if (recovery.recovery_last_us > recovery.recovery_max_us) recovery.recovery_max_us = recovery.recovery_last_us;
+    failedRecoveries++;
+    consecutiveFailures = 0;
+  }
+
+  static void trackHealth(Device device, I2CResult result) {
+    if (result == I2C_OK) {
+      consecutiveFailures = 0;
+      // Sight is back only once the sensor the FSM depends on answers again
+      if (device == DEVICE_MAGNETIC && !healthy.load(std::memory_order_relaxed)) {
+        recovery.blind_last_us = micros() - blindStart_us;
+        if (recovery.blind_last_us > recovery.blind_max_us) recovery.blind_max_us = recovery.blind_last_us;
+        failedRecoveries = 0;
+        healthy.store(true, std::memory_order_release);
+      }
+      return;
+    }
+    if (result == I2C_BUSY) return;  // Nothing reached the bus
+
+    if (consecutiveFailures == 0 && healthy.load(std::memory_order_relaxed)) blindStart_us = micros();
+    consecutiveFailures++;
+    if (consecutiveFailures >= I2C_HANG_FAIL_LIMIT) {
+      if (healthy.load(std::memory_order_relaxed)) recovery.faults++;
+      healthy.store(false, std::memory_order_release);
+      recoverBus();
+    }
+  }
+
+  static void busTaskFunction(void* parameter) {
+    for (;;) {
+      ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+      uint32_t slotStart = micros();
+
+      if (resetRequested) {
+        clearStats();
+        resetRequested = false;
+      }
+
+      for (int d = 0; d < DEVICE_COUNT; d++) {
+        Job& job = jobs[d];
+        if (!job.pending.load(std::memory_order_acquire)) continue;
+
+        // Anything below the top priority only runs if it ends before the next tick
+        uint32_t elapsed = micros() - slotStart;
+        bool fits = (d == DEVICE_MAGNETIC) || (elapsed + job.stats.expected_us <= I2C_SLOT_BUDGET_US);
+        if (!fits) {
+          bool overdue = (micros() - job.requested_us) >= job.deadline_us;
+          if (!overdue) {
+            if (!job.deferred) {
+              job.stats.deferred++;
+              job.deferred = true;
+            }
+            continue;
+          }
+          job.stats.forced++;
+        }
+
+        job.pending.store(false, std::memory_order_relaxed);
+        I2CResult result = runJob(job);
+
+        // One immediate retry if the slot still has room for it
+        if (result != I2C_OK && result != I2C_BUSY &&
+            (micros() - slotStart) + job.stats.expected_us <= I2C_SLOT_BUDGET_US) {
+          job.stats.retries++;
+          result = runJob(job);
+        }
+        trackHealth((Device)d, result);
+      }
+    }
+  }
+
+  bool start() {
+    for (int d = 0; d < DEVICE_COUNT; d++) {
+      jobs[d].stats.expected_us = initialExpectedUs[d];
+    }
+
+    xTaskCreatePinnedToCore(
+      busTaskFunction,
+      "I2CBusTask",
+      I2C_BUS_TASK_STACK_SIZE,
+      NULL,
+      I2C_BUS_TASK_PRIORITY,
+      &busTaskHandle,
+      CONTROL_TASK_CORE
+    );
+    if (busTaskHandle == NULL) {
+      Serial.println("[I2C] ERROR: Failed to create bus task");
+      return false;
+    }
+    Serial.printf("[I2C] ✓ Bus scheduler running (slot budget %lu us)\n", (unsigned long)I2C_SLOT_BUDGET_US);
+    return true;
+  }
+
+  void ARDUINO_ISR_ATTR tickFromISR(BaseType_t* higherPriorityTaskWoken) {
+    Job& mag = jobs[DEVICE_MAGNETIC];
+    mag.requested_us = micros();
+    mag.pending.store(true, std::memory_order_release);
+    vTaskNotifyGiveFromISR(busTaskHandle, higherPriorityTaskWoken);
+  }
+
+  void HOT_PATH request(Device device) {
+    Job& job = jobs[device];
+    // A request that is still queued keeps its original timestamp
+    if (job.pending.load(std::memory_order_acquire)) return;
+    job.requested_us = micros();
+    job.pending.store(true, std::memory_order_release);
+  }
+
+  bool isRunning() {
+    return busTaskHandle != NULL;
+  }
+
+  bool HOT_PATH isHealthy() {
+    return healthy.load(std::memory_order_acquire);
+  }
+
+  void resetStats() {
+    resetRequested = true;
+  }
+
+  void printReport(Print& out) {
+    out.printf("{\"type\":\"i2c\",\"running\":%d,\"healthy\":%d,\"slot_us\":%lu,\"bin_us\":%u,"
+               "\"recovery\":{\"faults\":%lu,\"runs\":%lu,\"power_cycles\":%lu,\"verify_fail\":%lu,\"last_us\":%lu,\"max_us\":%lu,"
+               "\"blind_us\":%lu,\"blind_max_us\":%lu},\"devices\":[",
+               isRunning() ? 1 : 0, isHealthy() ? 1 : 0,
+               (unsigned long)I2C_SLOT_BUDGET_US, (unsigned)I2C_HIST_BIN_US,
+               (unsigned long)recovery.faults, (unsigned long)recovery.recoveries,
+               (unsigned long)recovery.power_cycles, (unsigned long)recovery.verify_fails,
+               (unsigned long)recovery.recovery_last_us, (unsigned long)recovery.recovery_max_us,
+               (unsigned long)recovery.blind_last_us, (unsigned long)recovery.blind_max_us);
+    for (int d = 0; d < DEVICE_COUNT; d++) {
+      const DeviceStats& s = jobs[d].stats;
+      out.printf("%s{\"name\":\"%s\",\"n\":%lu,\"fail\":%lu,\"nack\":%lu,\"tmo\":%lu,\"busy\":%lu,\"retry\":%lu,"
+                 "\"deferred\":%lu,\"forced\":%lu,\"last\":%lu,\"max\":%lu,\"exp\":%lu,\"lat\":%lu,\"lat_max\":%lu,"
+                 "\"over\":%lu,\"hist\":[",
+                 d == 0 ? "" : ",", jobs[d].name,
+                 (unsigned long)s.transactions, (unsigned long)s.failures,
+                 (unsigned long)s.nacks, (unsigned long)s.timeouts, (unsigned long)s.busy,
+                 (unsigned long)s.retries,
+                 (unsigned long)s.deferred, (unsigned long)s.forced,
+                 (unsigned long)s.last_us, (unsigned long)s.max_us, (unsigned long)s.expected_us,
+                 (unsigned long)s.latency_last_us, (unsigned long)s.latency_max_us,
+                 (unsigned long)s.hist_overflow);
+      for (int i = 0; i < I2C_HIST_BINS; i++) {
+        out.printf(i == 0 ? "%lu" : ",%lu", (unsigned long)s.hist[i]);
+      }
+      out.print("]}");
+    }
+    out.print("]}");
+  }
+}
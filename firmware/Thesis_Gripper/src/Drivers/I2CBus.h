@@ -0,0 +1,90 @@
+#ifndef I2C_BUS_H
+#define I2C_BUS_H
+
+#include <Arduino.h>
+#include "../Config.h"
+
+// ============================================
+// I2C BUS SCHEDULER
+// Owns the shared bus once started. Each timer tick opens a slot: the
+// magnetic read is serviced first, lower-priority transactions (INA219)
+// only run if they are expected to finish before the next slot starts.
+// A run of failed transactions marks the bus unhealthy and triggers a
+// bounded recovery (SCL clocking, peripheral restart, sensor re-init).
+// ============================================
+
+// Outcome of one device transaction
+enum I2CResult : uint8_t {
+  I2C_OK,
+  I2C_NACK,     // Address or data not acknowledged
+  I2C_TIMEOUT,  // Transaction hit the Wire timeout (stuck bus)
+  I2C_BUSY,     // Bus mutex held elsewhere, nothing sent
+  I2C_ERROR     // Any other driver error
+};
+
+namespace I2CBus {
+  // Devices in priority order (lower value = serviced first)
+  enum Device : uint8_t {
+    DEVICE_MAGNETIC,
+    DEVICE_CURRENT,
+    DEVICE_COUNT
+  };
+
+  struct DeviceStats {
+    uint32_t transactions;
+    uint32_t failures;
+    uint32_t nacks;
+    uint32_t timeouts;
+    uint32_t busy;
+    uint32_t retries;         // Immediate re-attempts within the same slot
+    uint32_t deferred;        // Requests that had to wait for a later slot
+    uint32_t forced;          // Requests run past their deadline without a free slot
+    uint32_t last_us;         // Bus time of the last transaction
+    uint32_t max_us;
+    uint32_t expected_us;     // Running estimate used for slot fitting
+    uint32_t latency_last_us; // Request -> completion
+    uint32_t latency_max_us;
+    uint32_t hist[I2C_HIST_BINS]; // Transaction duration, I2C_HIST_BIN_US per bin
+    uint32_t hist_overflow;
+  };
+
+  struct RecoveryStats {
+    uint32_t faults;          // Times the bus was declared hung
+    uint32_t recoveries;      // Recovery sequences run
+    uint32_t power_cycles;    // Of those, with a sensor power reset
+    uint32_t verify_fails;    // Of those, sensor did not read back after re-configuration
+    uint32_t recovery_last_us;
+    uint32_t recovery_max_us;
+    uint32_t blind_last_us;   // First failed read -> first good magnetic read
+    uint32_t blind_max_us;
+  };
+
+  // Map a Wire.endTransmission() code to a result
+  I2CResult fromEndTransmission(uint8_t code);
+
+  // Classify a short requestFrom(): timeout if it took about the Wire timeout, else NACK
+  I2CResult fromRequest(size_t received, size_t wanted, uint32_t elapsed_us);
+
+  // Create the bus task; after this, device reads go through request()
+  bool start();
+
+  // Timer ISR hook: open the next slot (the magnetic read is always due)
+  void tickFromISR(BaseType_t* higherPriorityTaskWoken);
+
+  // Queue one transaction for a device (any task, never blocks)
+  void request(Device device);
+
+  bool isRunning();
+
+  // False from the point the bus is declared hung until a good magnetic read after recovery.
+  // The control task must not act on sensor data meanwhile.
+  bool isHealthy();
+
+  // Clear statistics (applied by the bus task)
+  void resetStats();
+
+  // Print per-device counters, histograms and recovery figures as one JSON object
+  void printReport(Print& out);
+}
+
+#endif // I2C_BUS_H
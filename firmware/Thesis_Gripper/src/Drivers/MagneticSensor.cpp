@@ -7,18 +7,67 @@ namespace MagneticSensor {
   // Static sensor instance
   static TLx493D_t sensor;
   
+  static ReadBench libraryBench = {0};
+  static ReadBench directBench = {0};
+  
+  // Async acquisition
+  static Seqlock<AcquiredSample> latestSample;
+  static uint32_t acqSequence = 0;
+  static uint32_t consumedSequence = 0;
+  static AcqStats acqStats = {0};
+  static uint32_t cpuMhz = 240;
+  static bool haveFrame = false;
+  static uint8_t lastFrame = 0;
+  static uint32_t lastNewCycles = 0;
+  
+  // Control task side: last two new conversions and the resampling grid
+  static AcquiredSample prevSample = {};
+  static AcquiredSample currSample = {};
+  static uint32_t gridCycles = 0;
+  static bool gridValid = false;
+  
+  // Sign-extend a 12-bit field left-aligned in a 16-bit word
+  static inline int16_t decode12(uint8_t high, uint8_t low_nibble) {
+    return (int16_t)(((uint16_t)high << 8) | ((uint16_t)low_nibble << 4)) >> 4;
+  }
+  
+  static I2CResult readRawUnlocked(MagneticRaw& raw) {
+    // A1B6 reads always start at register 0, so no address write is needed
+    uint8_t regs[TLV493D_BURST_BYTES];
+    uint32_t t0 = micros();
+    size_t received = Wire.requestFrom(MAGNETIC_I2C_ADDRESS, (size_t)TLV493D_BURST_BYTES);
+    I2CResult result = I2CBus::fromRequest(received, TLV493D_BURST_BYTES, micros() - t0);
+    if (result != I2C_OK) return result;
+    if (Wire.readBytes(regs, TLV493D_BURST_BYTES) != TLV493D_BURST_BYTES) return I2C_ERROR;
+    
+    raw.x = decode12(regs[0], regs[4] >> 4);
+    raw.y = decode12(regs[1], regs[4] & 0x0F);
+    raw.z = decode12(regs[2], regs[5] & 0x0F);
+    raw.frame = (regs[3] >> 2) & 0x03;
+    return I2C_OK;
+  }
+  
+  // One burst read after a reset: the sensor answers and returns a full frame
+  static bool readBack() {
+    MagneticRaw raw;
+    return readRawUnlocked(raw) == I2C_OK;
+  }
+  
   bool init() {
-    // Power up sensor
+    cpuMhz = getCpuFrequencyMhz();
+    
+    // Power up sensor (same off/on times as the bus recovery power cycle)
     pinMode(MAGNETIC_SENSOR_POWER_PIN, OUTPUT);
     digitalWrite(MAGNETIC_SENSOR_POWER_PIN, LOW);
-    delay(100);
+    delay(I2C_SENSOR_POWER_CYCLE_MS);
     digitalWrite(MAGNETIC_SENSOR_POWER_PIN, HIGH);
-    delay(100);
+    delay(I2C_SENSOR_POWER_CYCLE_MS);
     
     // Initialize I2C
     if (mutexI2C != NULL && xSemaphoreTake(mutexI2C, pdMS_TO_TICKS(100)) == pdTRUE) {
       Wire.begin(SDA_PIN, SCL_PIN);
       Wire.setClock(MAGNETIC_I2C_CLOCK_SPEED);
+      Wire.setTimeOut(I2C_TRANSACTION_TIMEOUT_MS);
       xSemaphoreGive(mutexI2C);
       Serial.println("[I2C] Initialized at 400kHz");
     } else {
@@ -64,91 +113,249 @@ namespace MagneticSensor {
         xSemaphoreGive(mutexI2C);
     }
     
-    delay(100);
+    bool readback_ok = false;
+    if (mutexI2C != NULL && xSemaphoreTake(mutexI2C, pdMS_TO_TICKS(100)) == pdTRUE) {
+        readback_ok = readBack();
+        xSemaphoreGive(mutexI2C);
+    }
+    if (!readback_ok) {
+      Serial.println("[SENSOR] ERROR: read-back after power-up failed!");
+      return false;
+    }
+    
+    // No settle delay: the first conversions only show up as duplicate frames
     Serial.println("[SENSOR] ✓ Ready");
     return true;
   }
   
-  bool read(double& x, double& y, double& z) {
+  bool reinit(bool powerCycle) {
+    if (powerCycle) {
+      digitalWrite(MAGNETIC_SENSOR_POWER_PIN, LOW);
+      vTaskDelay(pdMS_TO_TICKS(I2C_SENSOR_POWER_CYCLE_MS));
+      digitalWrite(MAGNETIC_SENSOR_POWER_PIN, HIGH);
+      vTaskDelay(pdMS_TO_TICKS(I2C_SENSOR_POWER_CYCLE_MS));
+    }
+    bool ok = tlx493d_setDefaultConfig(&sensor);
+    ok = ok && tlx493d_setPowerMode(&sensor, TLx493D_FAST_MODE_e);
+    ok = ok && tlx493d_setMeasurement(&sensor, TLx493D_BxByBz_e);
+    ok = ok && readBack();
+    
+    // Frame counter restarts; do not count the gap as skipped conversions
+    haveFrame = false;
+    return ok;
+  }
+  
+  I2CResult readRaw(MagneticRaw& raw) {
+    if (mutexI2C == NULL) return I2C_ERROR;
+    
+    I2CResult result = I2C_BUSY;
+    // Never wait on the bus from the control task; skip the sample if it is busy
+    if (xSemaphoreTake(mutexI2C, 0) == pdTRUE) {
+      result = readRawUnlocked(raw);
+      xSemaphoreGive(mutexI2C);
+    }
+    return result;
+  }
+  
+  bool read(float& x, float& y, float& z) {
+#if MAGNETIC_DIRECT_READ
+    MagneticRaw raw;
+    if (readRaw(raw) != I2C_OK) return false;
+    x = raw.x * TLV493D_MT_PER_LSB;
+    y = raw.y * TLV493D_MT_PER_LSB;
+    z = raw.z * TLV493D_MT_PER_LSB;
+    return true;
+#else
     if (mutexI2C == NULL) return false;
     
     bool result = false;
-    if (xSemaphoreTake(mutexI2C, pdMS_TO_TICKS(2)) == pdTRUE) {
-      result = tlx493d_getMagneticField(&sensor, &x, &y, &z);
+    if (xSemaphoreTake(mutexI2C, 0) == pdTRUE) {
+      double dx, dy, dz;
+      result = tlx493d_getMagneticField(&sensor, &dx, &dy, &dz);
       xSemaphoreGive(mutexI2C);
+      if (result) {
+        x = (float)dx;
+        y = (float)dy;
+        z = (float)dz;
+      }
     }
     return result;
+#endif
   }
   
-  void calibrate(CalibrationData& calData) {
-    Serial.println("\n=== Starting Calibration ===");
-    Serial.println("Reading sensor for 1 second...");
-    
-    double x, y, z;
-    bool first_reading = true;
-    unsigned long start_time = millis();
-    int reading_count = 0;
-    
-    while (millis() - start_time < 1000) {
-      if (read(x, y, z)) {
-        reading_count++;
-        
-        if (first_reading) {
-          calData.x_min = calData.x_max = x;
-          calData.y_min = calData.y_max = y;
-          calData.z_min = calData.z_max = z;
-          first_reading = false;
-        } else {
-          if (x < calData.x_min) calData.x_min = x;
-          if (x > calData.x_max) calData.x_max = x;
-          if (y < calData.y_min) calData.y_min = y;
-          if (y > calData.y_max) calData.y_max = y;
-          if (z < calData.z_min) calData.z_min = z;
-          if (z > calData.z_max) calData.z_max = z;
-        }
+  I2CResult serviceAcquisition() {
+    AcquiredSample sample;
+    I2CResult result = readRaw(sample.raw);
+    sample.cycles = esp_cpu_get_cycle_count();
+    sample.timestamp_us = micros();
+    acqStats.reads++;
+    if (result != I2C_OK) {
+      acqStats.failures++;
+      return result;
+    }
+    
+    // FRM tells whether this is a new conversion and how many were missed
+    if (haveFrame) {
+      uint8_t delta = (sample.raw.frame - lastFrame) & (TLV493D_FRAME_MODULO - 1);
+      if (delta == 0) {
+        acqStats.duplicates++;
+        return I2C_OK;
       }
+      acqStats.skipped += delta - 1;
+      
+      uint32_t interval = (sample.cycles - lastNewCycles) / cpuMhz;
+      if (acqStats.interval_min_us == 0 || interval < acqStats.interval_min_us) acqStats.interval_min_us = interval;
+      if (interval > acqStats.interval_max_us) acqStats.interval_max_us = interval;
     }
+    haveFrame = true;
+    lastFrame = sample.raw.frame;
+    lastNewCycles = sample.cycles;
     
-    // Calculate offset as average of min/max
-    calData.x_offset = (calData.x_min + calData.x_max) / 2.0;
-    calData.y_offset = (calData.y_min + calData.y_max) / 2.0;
-    calData.z_offset = (calData.z_min + calData.z_max) / 2.0;
-    
-    Serial.println("=== Calibration Complete ===");
-    Serial.print("Readings taken: ");
-    Serial.println(reading_count);
-    Serial.print("X offset: ");
-    Serial.print(calData.x_offset, 3);
-    Serial.print(" mT (range: ");
-    Serial.print(calData.x_min, 3);
-    Serial.print(" to ");
-    Serial.print(calData.x_max, 3);
-    Serial.println(")");
-    Serial.print("Y offset: ");
-    Serial.print(calData.y_offset, 3);
-    Serial.print(" mT (range: ");
-    Serial.print(calData.y_min, 3);
-    Serial.print(" to ");
-    Serial.print(calData.y_max, 3);
-    Serial.println(")");
-    Serial.print("Z offset: ");
-    Serial.print(calData.z_offset, 3);
-    Serial.print(" mT (range: ");
-    Serial.print(calData.z_min, 3);
-    Serial.print(" to ");
-    Serial.print(calData.z_max, 3);
-    Serial.println(")");
-    Serial.println();
-  }
-  
-  void applyCalibration(double& x, double& y, double& z, const CalibrationData& calData) {
-    x -= calData.x_offset;
-    y -= calData.y_offset;
-    z -= calData.z_offset;
-  }
-  
-  double calculateMagnitude(double x, double y, double z) {
-    return sqrt(x * x + y * y + z * z);
+    sample.sequence = ++acqSequence;
+    latestSample.write(sample);
+    return I2C_OK;
+  }
+  
+  static inline float HOT_PATH lerp(int16_t a, int16_t b, float f) {
+    return (a + (b - a) * f) * TLV493D_MT_PER_LSB;
+  }
+  
+  bool HOT_PATH acquire(float& x, float& y, float& z, uint32_t& timestamp_us) {
+#if !MAGNETIC_ASYNC_ACQUISITION && !MAGNETIC_DIRECT_READ
+    // Library path has no frame counter; plain read stamped now
+    timestamp_us = micros();
+    return read(x, y, z);
+#else
+  #if !MAGNETIC_ASYNC_ACQUISITION
+    serviceAcquisition();
+  #endif
+    AcquiredSample sample;
+    latestSample.read(sample);
+    bool fresh = sample.sequence != consumedSequence;
+    if (fresh) {
+      prevSample = currSample;
+      currSample = sample;
+      consumedSequence = sample.sequence;
+    } else {
+      acqStats.stale++;
+    }
+    
+  #if MAGNETIC_RESAMPLE
+    // Grid advances one scan period per cycle, trailing the newest conversion by one period
+    const uint32_t period = SCAN_INTERVAL_US * cpuMhz;
+    gridCycles += period;
+    int32_t lead = (int32_t)(currSample.cycles - gridCycles);
+    if (!gridValid || lead < 0 || lead > (int32_t)(2 * period)) {
+      gridCycles = currSample.cycles - period;  // Re-anchor after start-up or a stall
+      gridValid = true;
+    }
+    
+    float f = 1.0f;
+    int32_t span = (int32_t)(currSample.cycles - prevSample.cycles);
+    if (prevSample.sequence != 0 && span > 0) {
+      f = (float)(int32_t)(gridCycles - prevSample.cycles) / span;
+      if (f < 0.0f) f = 0.0f;
+      if (f > 1.0f) f = 1.0f;
+    }
+    x = lerp(prevSample.raw.x, currSample.raw.x, f);
+    y = lerp(prevSample.raw.y, currSample.raw.y, f);
+    z = lerp(prevSample.raw.z, currSample.raw.z, f);
+    timestamp_us = currSample.timestamp_us - (uint32_t)(currSample.cycles - gridCycles) / cpuMhz;
+    // A grid point still between two conversions is new data; one clamped to the newest is a repeat
+    fresh = fresh || f < 1.0f;
+  #else
+    x = currSample.raw.x * TLV493D_MT_PER_LSB;
+    y = currSample.raw.y * TLV493D_MT_PER_LSB;
+    z = currSample.raw.z * TLV493D_MT_PER_LSB;
+    timestamp_us = currSample.timestamp_us;
+  #endif
+    return fresh;
+#endif
+  }
+  
+  void getAcqStats(AcqStats& out) {
+    out = acqStats;
+  }
+  
+  static void finishBench(ReadBench& b, uint32_t total_us, uint32_t bytes) {
+    uint32_t ok = b.samples - b.failures;
+    b.bytes_per_sample = bytes;
+    b.us_per_sample = ok > 0 ? (float)total_us / ok : 0.0f;
+  }
+  
+  void benchmarkReadPaths() {
+    if (mutexI2C == NULL || xSemaphoreTake(mutexI2C, pdMS_TO_TICKS(100)) != pdTRUE) {
+      Serial.println("[SENSOR] Read benchmark skipped (I2C busy)");
+      return;
+    }
+    
+    uint32_t total_us = 0;
+    libraryBench = {0};
+    for (int i = 0; i < MAGNETIC_READ_BENCH_SAMPLES; i++) {
+      double dx, dy, dz;
+      uint32_t t0 = micros();
+      bool ok = tlx493d_getMagneticField(&sensor, &dx, &dy, &dz);
+      uint32_t dt = micros() - t0;
+      libraryBench.samples++;
+      if (!ok) { libraryBench.failures++; continue; }
+      total_us += dt;
+      if (dt > libraryBench.max_us) libraryBench.max_us = dt;
+    }
+    finishBench(libraryBench, total_us, TLV493D_LIBRARY_READ_BYTES);
+    
+    total_us = 0;
+    directBench = {0};
+    for (int i = 0; i < MAGNETIC_READ_BENCH_SAMPLES; i++) {
+      MagneticRaw raw;
+      uint32_t t0 = micros();
+      bool ok = readRawUnlocked(raw) == I2C_OK;
+      uint32_t dt = micros() - t0;
+      directBench.samples++;
+      if (!ok) { directBench.failures++; continue; }
+      total_us += dt;
+      if (dt > directBench.max_us) directBench.max_us = dt;
+    }
+    finishBench(directBench, total_us, TLV493D_BURST_BYTES);
+    
+    xSemaphoreGive(mutexI2C);
+    
+    Serial.printf("[SENSOR] Read path: library %.1f us / %lu B, direct %.1f us / %lu B per sample\n",
+                  libraryBench.us_per_sample, (unsigned long)libraryBench.bytes_per_sample,
+                  directBench.us_per_sample, (unsigned long)directBench.bytes_per_sample);
+  }
+  
+  static void printBench(Print& out, const char* name, const ReadBench& b) {
+    out.printf("\"%s\":{\"n\":%lu,\"fail\":%lu,\"bytes\":%lu,\"us\":%.1f,\"max_us\":%lu}",
+               name, (unsigned long)b.samples, (unsigned long)b.failures,
+               (unsigned long)b.bytes_per_sample, b.us_per_sample, (unsigned long)b.max_us);
+  }
+  
+  void printReadReport(Print& out) {
+    out.printf("{\"type\":\"mag_read\",\"active\":\"%s\",", MAGNETIC_DIRECT_READ ? "direct" : "library");
+    printBench(out, "library", libraryBench);
+    out.print(",");
+    printBench(out, "direct", directBench);
+    out.printf(",\"acq\":{\"async\":%d,\"resample\":%d,\"reads\":%lu,\"fail\":%lu,\"stale\":%lu,"
+               "\"dup\":%lu,\"skip\":%lu,\"int_min\":%lu,\"int_max\":%lu}}",
+               MAGNETIC_ASYNC_ACQUISITION ? 1 : 0, MAGNETIC_RESAMPLE ? 1 : 0,
+               (unsigned long)acqStats.reads, (unsigned long)acqStats.failures, (unsigned long)acqStats.stale,
+               (unsigned long)acqStats.duplicates, (unsigned long)acqStats.skipped,
+               (unsigned long)acqStats.interval_min_us, (unsigned long)acqStats.interval_max_us);
+  }
+  
+  void HOT_PATH applyCalibration(float& x, float& y, float& z, const CalibrationData& calData) {
+    const float dx = x - calData.x_offset;
+    const float dy = y - calData.y_offset;
+    const float dz = z - calData.z_offset;
+    // Fixed 9 multiply-adds, identity until a fitted matrix is loaded
+    const float (&m)[3][3] = calData.matrix;
+    x = m[0][0] * dx + m[0][1] * dy + m[0][2] * dz;
+    y = m[1][0] * dx + m[1][1] * dy + m[1][2] * dz;
+    z = m[2][0] * dx + m[2][1] * dy + m[2][2] * dz;
+  }
+  
+  float HOT_PATH calculateMagnitude(float x, float y, float z) {
+    return sqrtf(x * x + y * y + z * z);
   }
   
   TLx493D_t& getSensor() {
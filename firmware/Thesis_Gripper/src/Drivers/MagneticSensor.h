@@ -5,30 +5,73 @@
 #include "TLx493D_inc.hpp"
 #include "../Config.h"
 #include "../Types.h"
+#include "I2CBus.h"
 
 // ============================================
 // MAGNETIC SENSOR DRIVER
 // ============================================
 
 namespace MagneticSensor {
+  // Per-path read cost, measured at boot
+  struct ReadBench {
+    uint32_t samples;
+    uint32_t failures;
+    uint32_t bytes_per_sample;
+    float us_per_sample;
+    uint32_t max_us;
+  };
+  
+  // Async acquisition counters (bus timing is in the I2CBus report)
+  struct AcqStats {
+    uint32_t reads;
+    uint32_t failures;
+    uint32_t stale;       // Control cycles that found no new sample
+    uint32_t duplicates;  // Reads that returned an already seen conversion (same FRM)
+    uint32_t skipped;     // Conversions never read (FRM advanced by more than one)
+    uint32_t interval_min_us;  // Spacing of consecutive new conversions
+    uint32_t interval_max_us;
+  };
+  
   // Initialize the TLx493D sensor
   bool init();
   
-  // Read raw magnetic field values (x, y, z in mT)
-  bool read(double& x, double& y, double& z);
+  // Re-apply the measurement configuration after a bus recovery (caller holds the bus).
+  // With powerCycle the sensor supply is switched off first (TLV493D internal state reset).
+  // False if the configuration or the read-back that follows it fails.
+  bool reinit(bool powerCycle);
+  
+  // Burst-read registers 0-5 in one I2C transaction and decode to counts
+  I2CResult readRaw(MagneticRaw& raw);
   
-  // Calibrate sensor (determines offsets)
-  void calibrate(CalibrationData& calData);
+  // Read magnetic field values (x, y, z in mT) via the configured path
+  bool read(float& x, float& y, float& z);
   
-  // Apply calibration offsets to raw readings
-  void applyCalibration(double& x, double& y, double& z, const CalibrationData& calData);
+  // Apply calibration to raw readings: matrix * (raw - offset)
+  void applyCalibration(float& x, float& y, float& z, const CalibrationData& calData);
   
   // Calculate magnitude from x, y, z
-  double calculateMagnitude(double x, double y, double z);
+  float calculateMagnitude(float x, float y, float z);
+  
+  // I2C bus task job: read one sample and publish it for acquire()
+  I2CResult serviceAcquisition();
+  
+  // Control task side: sample for this cycle (sample completed during the previous period
+  // in async mode, a blocking bus read otherwise) and its acquisition time, or the value
+  // interpolated at this cycle's grid instant (MAGNETIC_RESAMPLE). Returns false if no
+  // new conversion arrived (or the grid point only repeats the newest one); the caller
+  // must then skip the sample.
+  bool acquire(float& x, float& y, float& z, uint32_t& timestamp_us);
+  
+  // Time both read paths (library vs direct); call before the control loop starts
+  void benchmarkReadPaths();
+  
+  void getAcqStats(AcqStats& out);
+  
+  // Print the boot-time read path comparison and acquisition counters as JSON
+  void printReadReport(Print& out);
   
   // Get sensor reference (for advanced usage)
   TLx493D_t& getSensor();
 }
 
 #endif // MAGNETIC_SENSOR_H
-
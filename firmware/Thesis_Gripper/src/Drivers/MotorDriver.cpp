@@ -1,14 +1,75 @@
 #include "MotorDriver.h"
 #include <HardwareSerial.h>
 #include <freertos/semphr.h>
+#include <Preferences.h>
+#include <soc/gpio_struct.h>
+#include <atomic>
 
 // Static member initialization
 volatile bool MotorDriver::enabled = false;
 volatile bool MotorDriver::initialized = false;
+volatile bool MotorDriver::homing = false;
+volatile bool MotorDriver::referenced = false;
+volatile uint32_t MotorDriver::stallIsrUs = 0;
+TaskHandle_t MotorDriver::homingWaiter = NULL;
+bool MotorDriver::positionStored = false;
+volatile bool MotorDriver::positionStale = false;
+uint32_t MotorDriver::restSinceMs = 0;
 TMC2209Stepper* MotorDriver::driver = nullptr;
 FastAccelStepperEngine MotorDriver::engine = FastAccelStepperEngine();
 FastAccelStepper* MotorDriver::stepper = nullptr;
 SemaphoreHandle_t MotorDriver::driverMutex = NULL;
+TaskHandle_t MotorDriver::uartTaskHandle = NULL;
+QueueHandle_t MotorDriver::motionQueue = NULL;
+volatile bool MotorDriver::segmentActive = false;
+std::atomic<uint32_t> MotorDriver::abortGeneration(0);
+
+// ----------------------------------------------------------------------------
+// Register shadow
+// Callers only store the requested value; the UART task writes a setting when
+// it differs from the last value written, and keeps SG_RESULT cached.
+// ----------------------------------------------------------------------------
+namespace {
+    enum Setting : uint8_t { SET_CURRENT, SET_SPREADCYCLE, SET_SGTHRS, SET_VACTUAL, SETTING_COUNT };
+    const char* const settingNames[SETTING_COUNT] = {"rms_current", "spreadcycle", "sgthrs", "vactual"};
+    // Values plus one valid bit per setting (every uint32_t is a legal register
+    // value, e.g. VACTUAL -1). A bit is set after its value has been stored.
+    std::atomic<uint32_t> requested[SETTING_COUNT];
+    std::atomic<uint32_t> applied[SETTING_COUNT];
+    std::atomic<uint8_t> requestedValid(0);
+    std::atomic<uint8_t> appliedValid(0);
+
+    inline bool isPending(uint8_t i) {
+        const uint8_t bit = 1u << i;
+        if (!(requestedValid.load(std::memory_order_acquire) & bit)) return false;
+        return !(appliedValid.load(std::memory_order_acquire) & bit) || requested[i].load() != applied[i].load();
+    }
+
+    // Queue entry: a segment queued before the last clearMotionQueue() is stale
+    struct QueuedSegment {
+        MotionSegment segment;
+        uint32_t generation;
+    };
+
+    std::atomic<int32_t> cachedLoad(0);
+    std::atomic<uint32_t> loadSequence(0);
+    uint32_t lastRefreshMs = 0;
+
+    // Read by the debug task while the UART task and callers update them
+    struct UartStats {
+        std::atomic<uint32_t> writes;     // Register writes sent
+        std::atomic<uint32_t> redundant;  // Set calls that matched the pending value (no write)
+        std::atomic<uint32_t> reads;      // SG_RESULT read-backs
+        std::atomic<uint32_t> max_us;     // Longest single UART transaction (UART task only)
+    };
+    UartStats uartStats = {};
+
+    inline void noteTransaction(uint32_t elapsed) {
+        if (elapsed > uartStats.max_us.load(std::memory_order_relaxed)) {
+            uartStats.max_us.store(elapsed, std::memory_order_relaxed);
+        }
+    }
+}
 
 void MotorDriver::init() {
     Serial.println("[MTR] init() starting...");
@@ -24,7 +85,6 @@ void MotorDriver::init() {
     // 2. Initialize Serial
     Serial.println("[MTR] Initializing Serial2...");
     Serial2.begin(115200, SERIAL_8N1, TMC_RX_PIN, TMC_TX_PIN);
-    delay(100); 
 
     // 3. Setup Pins
     // FastAccelStepper handles pins, but we ensure EN is initially high (disabled)
@@ -44,17 +104,28 @@ void MotorDriver::init() {
     driver->toff(5);
     driver->mstep_reg_select(true); // 1. Tell driver to IGNORE physical MS1/MS2 pins
     driver->microsteps(TMC_MICROSTEPS);
-    driver->rms_current(TMC_RUN_CURRENT);
     driver->iholddelay(10);
-    driver->en_spreadCycle(true); // StealthChop
     driver->pwm_autoscale(true);
     driver->TCOOLTHRS(0xFFFFF);
-    driver->SGTHRS(TMC_STALL_VALUE);
-    
-    // IMPORTANT: Set VACTUAL to 0 to enable STEP/DIR control
-    driver->VACTUAL(0);
     Serial.print("[MTR] Driver sees Microsteps: ");
     Serial.println(driver->microsteps()); 
+
+    // Settings that change at runtime go through the shadow and the UART task
+    requestedValid.store(0);
+    appliedValid.store(0);
+    if (xTaskCreatePinnedToCore(uartTaskFunction, "TmcUart", TMC_UART_TASK_STACK_SIZE, NULL,
+                                TMC_UART_TASK_PRIORITY, &uartTaskHandle, TMC_UART_TASK_CORE) != pdPASS) {
+        Serial.println("[MTR-FATAL] Failed to create UART task!");
+        return;
+    }
+    setRunCurrent(TMC_RUN_CURRENT);
+    setSpreadCycle(true); // StealthChop
+    setStallThreshold(TMC_STALL_VALUE);
+    // IMPORTANT: Set VACTUAL to 0 to enable STEP/DIR control
+    setVActual(0);
+    if (!waitConfigApplied(TMC_CONFIG_APPLY_TIMEOUT_MS)) {
+        Serial.println("[MTR] Warning: driver configuration not confirmed");
+    }
     Serial.println("[MTR] Driver configuration complete (STEP/DIR mode)");
 
     // 5. FastAccelStepper Setup
@@ -76,16 +147,25 @@ void MotorDriver::init() {
         Serial.println("[MTR-FATAL] Failed to create stepper!");
     }
 
+    // 6. Segment queue and its executor
+    motionQueue = xQueueCreate(MOTION_QUEUE_LENGTH, sizeof(QueuedSegment));
+    if (motionQueue == NULL ||
+        xTaskCreatePinnedToCore(motionTaskFunction, "Motion", MOTION_TASK_STACK_SIZE, NULL,
+                                MOTION_TASK_PRIORITY, NULL, MOTION_TASK_CORE) != pdPASS) {
+        Serial.println("[MTR-FATAL] Failed to create motion task!");
+        return;
+    }
+
     initialized = true;
     Serial.println("[MTR] init() complete");
 }
 
 void MotorDriver::moveTo(long absolutePosition) {
-    if (stepper) stepper->moveTo(absolutePosition);
+    if (initialized && stepper && referenced && !homing) stepper->moveTo(absolutePosition);
 }
 
 void MotorDriver::moveRelative(long relativePosition) {
-    if (stepper) stepper->move(relativePosition);
+    if (initialized && stepper && referenced && !homing) stepper->move(relativePosition);
 }
 
 long MotorDriver::getPosition() {
@@ -98,14 +178,21 @@ long MotorDriver::getTargetPosition() {
     return 0;
 }
 
+bool MotorDriver::isMoving() {
+    // Read from the control task while init may still run on the other core
+    if (initialized && stepper) return stepper->isRunning();
+    return false;
+}
+
 void MotorDriver::setTargetSpeed(int32_t speed) {
-    if (!stepper) return;
+    if (!initialized || !stepper || homing) return;
     
     if (speed == 0) {
-        stepper->stopMove();
+        clearMotionQueue();
         enabled = false;
     } else {
         // speed is in steps/s
+        if (!referenced) return;
         uint32_t speedAbs = abs(speed);
         if (speedAbs > TMC_MAX_SPEED) speedAbs = TMC_MAX_SPEED;
         if (speedAbs < 100) speedAbs = 100; // Minimum speed safety?
@@ -133,63 +220,192 @@ void MotorDriver::disable() {
     if (stepper) stepper->disableOutputs();
 }
 
+// ----------------------------------------------------------------------------
+// Driver configuration (never blocks on the UART)
+// ----------------------------------------------------------------------------
+
+static void requestSetting(Setting setting, uint32_t value, TaskHandle_t uartTask) {
+    const uint8_t bit = 1u << setting;
+    uint32_t previous = requested[setting].exchange(value);
+    bool wasValid = requestedValid.fetch_or(bit, std::memory_order_release) & bit;
+    if (wasValid && previous == value) {
+        uartStats.redundant.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+    if (uartTask != NULL) xTaskNotifyGive(uartTask);
+}
+
+void MotorDriver::setRunCurrent(uint16_t mA) {
+    requestSetting(SET_CURRENT, mA, uartTaskHandle);
+}
+
+void MotorDriver::setSpreadCycle(bool enabled) {
+    requestSetting(SET_SPREADCYCLE, enabled ? 1 : 0, uartTaskHandle);
+}
+
+void MotorDriver::setStallThreshold(uint8_t threshold) {
+    requestSetting(SET_SGTHRS, threshold, uartTaskHandle);
+}
+
+void MotorDriver::setVActual(int32_t velocity) {
+    requestSetting(SET_VACTUAL, (uint32_t)velocity, uartTaskHandle);
+}
+
+bool MotorDriver::waitConfigApplied(uint32_t timeoutMs) {
+    uint32_t start = millis();
+    for (;;) {
+        bool pending = false;
+        for (uint8_t i = 0; i < SETTING_COUNT; i++) {
+            if (isPending(i)) pending = true;
+        }
+        if (!pending) return true;
+        if (millis() - start >= timeoutMs) return false;
+        delay(1);
+    }
+}
+
 int32_t MotorDriver::getLoad() {
-    if (!initialized || !driver) return 0;
-    
-    int32_t result = 0;
-    if (xSemaphoreTakeRecursive(driverMutex, pdMS_TO_TICKS(10)) == pdTRUE) {
-        result = driver->SG_RESULT();
+    return cachedLoad.load(std::memory_order_relaxed);
+}
+
+uint32_t MotorDriver::getLoadSequence() {
+    return loadSequence.load(std::memory_order_acquire);
+}
+
+void MotorDriver::writeSetting(uint8_t setting, uint32_t value) {
+    switch (setting) {
+        case SET_CURRENT:     driver->rms_current((uint16_t)value); break;
+        case SET_SPREADCYCLE: driver->en_spreadCycle(value != 0); break;
+        case SET_SGTHRS:      driver->SGTHRS((uint8_t)value); break;
+        case SET_VACTUAL:     driver->VACTUAL(value); break;
+    }
+}
+
+// Sole user of Serial2 after init: flushes changed settings, refreshes SG_RESULT
+void MotorDriver::uartTaskFunction(void* parameter) {
+    for (;;) {
+        ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(TMC_LOAD_REFRESH_MS));
+
+        if (xSemaphoreTakeRecursive(driverMutex, portMAX_DELAY) != pdTRUE) continue;
+
+        for (uint8_t i = 0; i < SETTING_COUNT; i++) {
+            if (!isPending(i)) continue;
+            uint32_t value = requested[i].load();
+            uint32_t start = micros();
+            writeSetting(i, value);
+            noteTransaction(micros() - start);
+            uartStats.writes.fetch_add(1, std::memory_order_relaxed);
+            applied[i].store(value);
+            appliedValid.fetch_or(1u << i, std::memory_order_release);
+        }
+
+        // SG_RESULT only matters while moving; idle refreshes just keep the value alive
+        uint32_t period = (stepper && stepper->isRunning()) ? TMC_LOAD_REFRESH_MS : TMC_LOAD_IDLE_REFRESH_MS;
+        if (millis() - lastRefreshMs >= period) {
+            lastRefreshMs = millis();
+            uint32_t start = micros();
+            cachedLoad.store(driver->SG_RESULT(), std::memory_order_relaxed);
+            noteTransaction(micros() - start);
+            uartStats.reads.fetch_add(1, std::memory_order_relaxed);
+            loadSequence.fetch_add(1, std::memory_order_release);
+        }
+
         xSemaphoreGiveRecursive(driverMutex);
     }
-    return result;
 }
 
-void MotorDriver::runHomingRoutine() {
-    Serial.println("[MTR] Homing routine starting...");
-    if (!initialized || !stepper) {
-        Serial.println("[MTR] Not initialized, cannot home.");
-        return;
+void MotorDriver::printReport(Print& out) {
+    out.printf("{\"type\":\"tmc\",\"writes\":%lu,\"redundant\":%lu,\"reads\":%lu,\"max_us\":%lu,"
+               "\"load\":%ld,\"load_seq\":%lu,\"referenced\":%d,\"settings\":{",
+               (unsigned long)uartStats.writes.load(), (unsigned long)uartStats.redundant.load(),
+               (unsigned long)uartStats.reads.load(), (unsigned long)uartStats.max_us.load(),
+               (long)getLoad(), (unsigned long)getLoadSequence(), referenced ? 1 : 0);
+    const uint8_t written = appliedValid.load(std::memory_order_acquire);
+    for (uint8_t i = 0; i < SETTING_COUNT; i++) {
+        if (written & (1u << i)) {
+            out.printf("%s\"%s\":%ld", i == 0 ? "" : ",", settingNames[i], (long)(int32_t)applied[i].load());
+        } else {
+            out.printf("%s\"%s\":null", i == 0 ? "" : ",", settingNames[i]);
+        }
+    }
+    uint8_t pending = 0;
+    for (uint8_t i = 0; i < SETTING_COUNT; i++) {
+        if (isPending(i)) pending++;
     }
+    out.printf("},\"pending\":%u}", (unsigned)pending);
+}
 
-    // 1. Setup for homing
-    if (xSemaphoreTakeRecursive(driverMutex, portMAX_DELAY) == pdTRUE) {
-        driver->rms_current(TMC_HOMING_CURRENT); 
-        driver->en_spreadCycle(false);
-        driver->SGTHRS(TMC_HOMING_THRESHOLD);
-        xSemaphoreGiveRecursive(driverMutex);
+// ----------------------------------------------------------------------------
+// Homing
+// StallGuard reads low while the motor accelerates, so stall detection is
+// blanked until the ramp reaches homing speed. The stall is then taken from the
+// DIAG output (GPIO interrupt) or, without it, by polling SG_RESULT over UART.
+// The ramp is FastAccelStepper's commanded speed, not a measurement: a carriage
+// already blocked during the ramp is caught by that first stall check, which
+// sees DIAG high / SG_RESULT low straight after blanking.
+// ----------------------------------------------------------------------------
+
+// Stall edge on DIAG: cut the coil current at once, the homing task stops the pulses
+void ARDUINO_ISR_ATTR MotorDriver::onDiagStall() {
+    GPIO.out_w1ts = (1UL << TMC_EN_PIN);
+    stallIsrUs = micros();
+    BaseType_t woken = pdFALSE;
+    if (homingWaiter != NULL) vTaskNotifyGiveFromISR(homingWaiter, &woken);
+    portYIELD_FROM_ISR(woken);
+}
+
+// Blanking only: waits until the commanded speed has ramped up (plus a margin).
+// False if the pulse generator stopped or the ramp did not finish in time.
+bool MotorDriver::waitForHomingSpeed() {
+    const uint32_t targetMilliHz = (uint32_t)TMC_HOMING_SPEED * 1000UL * 95 / 100;
+    const uint32_t timeoutMs = 2 * TMC_HOMING_RAMP_MS + TMC_HOMING_BLANK_MARGIN_MS;
+    uint32_t start = millis();
+    while (millis() - start < timeoutMs) {
+        if (!stepper->isRunning()) return false;
+        if ((uint32_t)abs(stepper->getCurrentSpeedInMilliHz()) >= targetMilliHz) {
+            delay(TMC_HOMING_BLANK_MARGIN_MS);
+            return true;
+        }
+        delay(1);
     }
+    return false;
+}
 
-    // 1.5 Move AWAY first
-    Serial.println("[MTR] Moving AWAY from home...");
-    
-    stepper->setSpeedInHz(TMC_HOMING_SPEED);
-    
-    if (TMC_HOMING_DIRECTION > 0) {
-        stepper->runBackward(); 
-    } else {
-        stepper->runForward();
+bool MotorDriver::waitForDiagStall() {
+    homingWaiter = xTaskGetCurrentTaskHandle();
+    ulTaskNotifyTake(pdTRUE, 0);  // Drop a stale notification
+    attachInterrupt(digitalPinToInterrupt(TMC_DIAG_PIN), onDiagStall, RISING);
+
+    // DIAG may already be high; the edge would never come
+    bool stalled = digitalRead(TMC_DIAG_PIN) == HIGH;
+    if (stalled) stallIsrUs = micros();
+    if (!stalled) {
+        stalled = ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(TMC_HOMING_TIMEOUT_MS)) > 0;
     }
-    
-    delay(5000); // Run for 5 seconds
-    stepper->forceStop(); 
-    delay(1000);
 
-    // 2. Move TOWARDS home and check Stall
-    Serial.println("[MTR] Moving TOWARDS home...");
-    if (TMC_HOMING_DIRECTION > 0) {
-        stepper->runForward();
-    } else {
-        stepper->runBackward();
+    detachInterrupt(digitalPinToInterrupt(TMC_DIAG_PIN));
+    homingWaiter = NULL;
+    if (stalled) {
+        stepper->forceStop();
+        Serial.printf("[MTR] Stall on DIAG, pulses stopped %lu us after the edge\n",
+                      (unsigned long)(micros() - stallIsrUs));
     }
+    return stalled;
+}
 
+bool MotorDriver::pollStallGuard() {
     unsigned long startTime = millis();
-    bool stalled = false;
-    
-    delay(2000); // Skip acceleration spike
-
     int consecutiveStalls = 0;
+    uint32_t seenSequence = getLoadSequence();
 
     while (millis() - startTime < TMC_HOMING_TIMEOUT_MS) {
+        // Each refresh of the cached SG_RESULT counts once
+        if (getLoadSequence() == seenSequence) {
+            if (!stepper->isRunning()) break;
+            delay(1);
+            continue;
+        }
+        seenSequence = getLoadSequence();
         int32_t load = getLoad(); 
         if ((millis() % 200) == 0) Serial.printf("[MTR] Load: %d\n", load);
 
@@ -197,48 +413,264 @@ void MotorDriver::runHomingRoutine() {
              consecutiveStalls++;
              if (consecutiveStalls >= TMC_HOMING_CONSECUTIVE_STALLS) {
                  Serial.printf("[MTR] Stall detected! Load: %d < %d (Consecutive: %d)\n", load, TMC_HOMING_THRESHOLD, consecutiveStalls);
-                 stalled = true;
-                 break;
+                 stepper->forceStop();
+                 return true;
              }
         } else {
              consecutiveStalls = 0;
         }
         
         if (!stepper->isRunning()) break;
-        
-        delay(10);
     }
-
-    // 3. Stop
     stepper->forceStop();
-    
-    if (!stalled) {
-        Serial.println("[MTR] Homing timed out without stall.");
+    return false;
+}
+
+void MotorDriver::runHomingRoutine() {
+    Serial.println("[MTR] Homing routine starting...");
+    if (!initialized || !stepper) {
+        Serial.println("[MTR] Not initialized, cannot home.");
+        return;
     }
+    homing = true;
+    referenced = false;
+    if (motionQueue != NULL) xQueueReset(motionQueue);
+    stepper->stopMove();
+    while (segmentActive || stepper->isRunning()) delay(1);
+    positionStale = true;  // Cleared in NVS by servicePersistence() once the gripper is OPEN
+    uint32_t startMs = millis();
+    stepper->setAcceleration(TMC_ACCELERATION);
+    stepper->setLinearAcceleration(0);  // Blanking assumes the plain v/a ramp
 
+    // 1. Setup for homing (must be in the driver before the approach)
+    setRunCurrent(TMC_HOMING_CURRENT);
+    setSpreadCycle(false);
+    setStallThreshold(TMC_HOMING_THRESHOLD);
+    if (!waitConfigApplied(TMC_CONFIG_APPLY_TIMEOUT_MS)) {
+        Serial.println("[MTR] Warning: homing configuration not confirmed");
+    }
+
+    // 1.5 Move AWAY first (leaves room to reach homing speed before the stop)
+    Serial.println("[MTR] Moving AWAY from home...");
+    stepper->setSpeedInHz(TMC_HOMING_SPEED);
+    stepper->move(-TMC_HOMING_DIRECTION * mmToSteps(TMC_HOMING_BACKOFF_MM));
+    while (stepper->isRunning()) delay(1);
+
+    // 2. Move TOWARDS home and check Stall
+    Serial.println("[MTR] Moving TOWARDS home...");
+    if (TMC_HOMING_DIRECTION > 0) {
+        stepper->runForward();
+    } else {
+        stepper->runBackward();
+    }
+
+    bool stalled;
+    if (!waitForHomingSpeed()) {
+        Serial.println("[MTR] Homing ramp aborted before reaching homing speed.");
+        stepper->forceStop();
+        stalled = false;
+    } else if (TMC_DIAG_PIN >= 0) {
+        stalled = waitForDiagStall();
+    } else {
+        stalled = pollStallGuard();
+    }
+
+    // 3. Stop (pulse generator; with DIAG the coils are already off)
+    while (stepper->isRunning()) delay(1);
+    stepper->disableOutputs();
+    
     // 4. Reset Position and Config
     stepper->setCurrentPosition(0);
     
-    if (xSemaphoreTakeRecursive(driverMutex, portMAX_DELAY) == pdTRUE) {
-        stepper->setSpeedInHz(TMC_MAX_SPEED);
-        stepper->setAcceleration(TMC_ACCELERATION);
-        driver->rms_current(TMC_RUN_CURRENT);
-        driver->SGTHRS(TMC_STALL_VALUE);
-        xSemaphoreGiveRecursive(driverMutex);
-    }
+    stepper->setSpeedInHz(TMC_MAX_SPEED);
+    stepper->setAcceleration(TMC_ACCELERATION);
+    setRunCurrent(TMC_RUN_CURRENT);
+    setStallThreshold(TMC_STALL_VALUE);
     
-    Serial.println("[MTR] Homing routine complete.");
+    if (stalled) {
+        // The new zero is stored like any other rest position (OPEN and settled)
+        referenced = true;
+    } else {
+        // Zero unknown: moves stay blocked until {"home":true} succeeds
+        Serial.println("[MTR] Homing timed out without stall, lift not referenced.");
+    }
+    homing = false;
+    Serial.printf("[MTR] Homing routine complete (%lu ms, %s).\n",
+                  (unsigned long)(millis() - startMs), TMC_DIAG_PIN >= 0 ? "DIAG" : "UART poll");
    
 }
 
+void MotorDriver::homingTaskFunction(void* parameter) {
+    runHomingRoutine();
+    vTaskDelete(NULL);
+}
+
+bool MotorDriver::requestHoming() {
+    if (!initialized || homing) return false;
+    homing = true;  // Block moves until the task has taken over
+    BaseType_t ok = xTaskCreatePinnedToCore(homingTaskFunction, "Homing", HOMING_TASK_STACK_SIZE,
+                                            NULL, HOMING_TASK_PRIORITY, NULL, HOMING_TASK_CORE);
+    if (ok != pdPASS) {
+        homing = false;
+        return false;
+    }
+    return true;
+}
+
+bool MotorDriver::isHoming() {
+    return homing;
+}
+
+bool MotorDriver::isReferenced() {
+    return referenced;
+}
+
+// ----------------------------------------------------------------------------
+// Persistent position
+// A position is only trusted if the lift was at rest when it was written:
+// the flag is cleared in NVS before the lift moves, so a reset or power loss
+// while moving forces a homing run on the next boot. Both writes happen with
+// the gripper OPEN, never while an object is held (flash writes stall the
+// scan cycle on the other core). Homing never writes itself: it only marks
+// the stored position stale and leaves the NVS write to servicePersistence().
+// ----------------------------------------------------------------------------
+
+void MotorDriver::storePosition(bool valid, long position) {
+    Preferences prefs;
+    if (!prefs.begin(LIFT_NVS_NAMESPACE, false)) return;
+    if (valid) prefs.putInt("pos", (int32_t)position);
+    prefs.putBool("valid", valid);
+    prefs.end();
+    positionStored = valid;
+}
+
+bool MotorDriver::restorePosition() {
+    if (!initialized || !stepper) return false;
+
+    Preferences prefs;
+    if (!prefs.begin(LIFT_NVS_NAMESPACE, true)) return false;
+    bool valid = prefs.getBool("valid", false);
+    int32_t position = prefs.getInt("pos", 0);
+    prefs.end();
+
+    if (!valid) return false;
+    stepper->setCurrentPosition(position);
+    positionStored = true;
+    referenced = true;
+    Serial.printf("[MTR] Position restored: %ld steps\n", (long)position);
+    return true;
+}
+
+bool MotorDriver::servicePersistence(bool gripperOpen) {
+    if (!initialized || !stepper) return false;
+
+    // Homing discarded the reference: the stored position must go before anything else,
+    // and (unlike a plain move) only with the gripper OPEN, since homing may run while HOLDING
+    if (positionStale) {
+        if (!gripperOpen) return false;
+        positionStale = false;
+        if (positionStored) {
+            storePosition(false, 0);
+            return true;
+        }
+    }
+
+    // Before the boot restore has read NVS (or homing has set a zero) the stepper's
+    // position is a placeholder 0; writing it would fake a valid reference
+    if (homing || !referenced) return false;
+
+    // Between queued segments the lift is not "at rest"
+    bool moving = !isMotionIdle();
+    if (moving) {
+        restSinceMs = 0;
+    } else if (restSinceMs == 0) {
+        restSinceMs = millis() | 1;
+    }
+
+    if (positionStored) {
+        // A grasp comes before any held lift: invalidate while nothing is held yet.
+        // A move with the gripper OPEN invalidates at once.
+        if (!moving && gripperOpen) return false;
+        storePosition(false, 0);
+        return true;
+    }
+    if (moving || !gripperOpen || millis() - restSinceMs < LIFT_SAVE_SETTLE_MS) return false;
+    storePosition(true, stepper->getCurrentPosition());
+    return true;
+}
+
 long MotorDriver::mmToSteps(float mm) {
     return (long)round(mm * TMC_STEPS_PER_MM);
 }
 
 void MotorDriver::moveToMM(float mm) {
-     moveTo(mmToSteps(mm));
+    clearMotionQueue();
+    queueSegment({mm, LIFT_MAX_SPEED_MM_S, LIFT_DEFAULT_ACCEL_MM_S2, LIFT_DEFAULT_START_STOP_JERK_MM_S3});
 }
 
 void MotorDriver::moveRelativeMM(float mm) {
     moveRelative(mmToSteps(mm));
 }
+
+// ----------------------------------------------------------------------------
+// Segment queue
+// Start/stop jerk limit by FastAccelStepper's linear acceleration phase: starting from and
+// stopping at standstill, the acceleration ramps 0 -> a over n steps. With
+// constant jerk j that phase lasts t = a/j and covers s = j*t^3/6 = a^3 / (6 j^2).
+// It is not a full S-curve: the accel -> cruise (and cruise -> decel)
+// transition still steps the acceleration.
+// ----------------------------------------------------------------------------
+
+static uint32_t startStopRampSteps(float accel_mm_s2, float start_stop_jerk_mm_s3) {
+    if (start_stop_jerk_mm_s3 <= 0.0f) return 0;
+    const float j = start_stop_jerk_mm_s3;
+    float ramp_mm = accel_mm_s2 * accel_mm_s2 * accel_mm_s2 / (6.0f * j * j);
+    return (uint32_t)lroundf(ramp_mm * TMC_STEPS_PER_MM);
+}
+
+bool MotorDriver::queueSegment(const MotionSegment& segment) {
+    if (!initialized || !stepper || !referenced || homing || motionQueue == NULL) return false;
+    if (!(segment.position_mm >= 0.0f && segment.position_mm <= LIFT_TRAVEL_MM)) return false;
+    QueuedSegment entry = {segment, abortGeneration.load(std::memory_order_acquire)};
+    return xQueueSend(motionQueue, &entry, 0) == pdTRUE;
+}
+
+void MotorDriver::clearMotionQueue() {
+    if (!initialized || !stepper || motionQueue == NULL) return;
+    // Invalidate first: a segment the motion task has already dequeued but not yet
+    // started sees the new generation and is dropped (or stopped right after moveTo)
+    abortGeneration.fetch_add(1, std::memory_order_acq_rel);
+    xQueueReset(motionQueue);
+    stepper->stopMove();  // Ramps down with the current profile (jerk-limited into standstill)
+}
+
+bool MotorDriver::isMotionIdle() {
+    if (!initialized || !stepper) return false;
+    return uxQueueMessagesWaiting(motionQueue) == 0 && !segmentActive && !stepper->isRunning();
+}
+
+void MotorDriver::motionTaskFunction(void* parameter) {
+    QueuedSegment entry;
+    for (;;) {
+        if (xQueueReceive(motionQueue, &entry, portMAX_DELAY) != pdTRUE) continue;
+        segmentActive = true;
+        const MotionSegment& seg = entry.segment;
+        if (homing || entry.generation != abortGeneration.load(std::memory_order_acquire)) {
+            segmentActive = false;
+            continue;
+        }
+
+        float speed = constrain(seg.speed_mm_s, 0.01f, LIFT_MAX_SPEED_MM_S);
+        float accel = constrain(seg.accel_mm_s2, 0.01f, LIFT_MAX_ACCEL_MM_S2);
+        stepper->setSpeedInHz((uint32_t)lroundf(speed * TMC_STEPS_PER_MM));
+        stepper->setAcceleration((int32_t)lroundf(accel * TMC_STEPS_PER_MM));
+        stepper->setLinearAcceleration(startStopRampSteps(accel, seg.start_stop_jerk_mm_s3));
+        stepper->moveTo(mmToSteps(seg.position_mm));
+        // A clear that landed between the check above and moveTo() must still win
+        if (entry.generation != abortGeneration.load(std::memory_order_acquire)) stepper->stopMove();
+
+        // Ends at the target or after clearMotionQueue() ramped it down
+        while (stepper->isRunning()) vTaskDelay(1);
+        segmentActive = false;
+    }
+}
@@ -5,6 +5,15 @@
 #include <TMCStepper.h>
 #include <FastAccelStepper.h>
 #include "../Config.h"
+#include <atomic>
+
+// One queued lift move (executed in order by the motion task)
+struct MotionSegment {
+    float position_mm;   // Absolute target
+    float speed_mm_s;    // Cruise speed (clamped to LIFT_MAX_SPEED_MM_S)
+    float accel_mm_s2;   // Ramp acceleration (clamped to LIFT_MAX_ACCEL_MM_S2)
+    float start_stop_jerk_mm_s3;  // Jerk limit at standstill start/stop only; 0 = trapezoid
+};
 
 class MotorDriver {
 public:
@@ -15,9 +24,16 @@ public:
     static void moveRelative(long relativePosition); 
     static long getPosition(); // Changed float to long
     static long getTargetPosition(); // Changed float to long
+    static bool isMoving();
     static long mmToSteps(float mm);
-    static void moveToMM(float mm);
+    static void moveToMM(float mm);     // Replaces queued moves, default profile
     static void moveRelativeMM(float mm);
+
+    // Jerk-limited segment queue (never blocks; false if the queue is full, homing, or the
+    // target lies outside 0..LIFT_TRAVEL_MM)
+    static bool queueSegment(const MotionSegment& segment);
+    static void clearMotionQueue();     // Drop queued segments and ramp down the current one
+    static bool isMotionIdle();         // Queue empty, no segment running, stepper at rest
     // Manual/Speed Control (Overrides Position Control)
     static void setTargetSpeed(int32_t speed);
     
@@ -25,14 +41,51 @@ public:
     static void stop();
     static void enable();
     static void disable();
+
+    // Driver configuration: shadowed, written by the UART task (never blocks)
+    static void setRunCurrent(uint16_t mA);
+    static void setSpreadCycle(bool enabled);
+    static void setStallThreshold(uint8_t threshold);
+    static void setVActual(int32_t velocity);
+    static bool waitConfigApplied(uint32_t timeoutMs);  // Homing/init only
+
+    // Cached SG_RESULT, refreshed by the UART task
     static int32_t getLoad();
+    static uint32_t getLoadSequence();  // Increments on every refresh
+
+    // Print UART/shadow statistics as one JSON object
+    static void printReport(Print& out);
 
     // Homing
     static void runHomingRoutine();
+    static bool requestHoming();    // Re-home in a background task (debug command)
+    static bool isHoming();
+    static bool isReferenced();
+
+    // Persistent position (fast boot)
+    static bool restorePosition();  // Load the stored position; false = homing needed
+    // Debug task: invalidate before a move or grasp, store once settled and OPEN; true if NVS was written
+    static bool servicePersistence(bool gripperOpen);
 
 private:
     static volatile bool enabled;
     static volatile bool initialized;  // True after successful init
+    static volatile bool homing;
+    static volatile bool referenced;   // Position known: restored from NVS or homed (moves and persistence wait for it)
+    static bool positionStored;        // Mirrors the NVS validity flag
+    static volatile bool positionStale; // Set by homing: stored position no longer valid (debug task clears NVS)
+    static uint32_t restSinceMs;       // Start of the current rest period (0 = moving)
+    
+    static void storePosition(bool valid, long position);
+    static void homingTaskFunction(void* parameter);
+
+    // Homing stages
+    static volatile uint32_t stallIsrUs;  // micros() of the DIAG edge
+    static TaskHandle_t homingWaiter;     // Task notified by the DIAG ISR
+    static void onDiagStall();
+    static bool waitForHomingSpeed();
+    static bool waitForDiagStall();
+    static bool pollStallGuard();
     
     // TMC2209 driver pointer (initialized in init())
     static TMC2209Stepper* driver;
@@ -43,6 +96,17 @@ private:
     
     // Mutex for driver access
     static SemaphoreHandle_t driverMutex;
+
+    // Motion task (executes the segment queue)
+    static QueueHandle_t motionQueue;
+    static volatile bool segmentActive;
+    static std::atomic<uint32_t> abortGeneration;  // Bumped by clearMotionQueue()
+    static void motionTaskFunction(void* parameter);
+
+    // UART task (sole user of Serial2 after init)
+    static TaskHandle_t uartTaskHandle;
+    static void uartTaskFunction(void* parameter);
+    static void writeSetting(uint8_t setting, uint32_t value);
 };
 
 #endif // MOTOR_DRIVER_H
@@ -9,59 +9,19 @@
 // EXTERN DECLARATIONS FOR SHARED STATE
 // ============================================
 
-// Timing
-extern volatile bool newDataAvailable;
-extern unsigned long lastSampleTime;
-extern unsigned long currentSampleTime;
-extern int measuredInterval;
-
-// Magnetic field data
-extern MagneticData magData;
-
 // Calibration data
 extern CalibrationData calData;
 
-// Current measurement
-extern float current_mA;
-extern unsigned long last_current_read;
-
-// Button state
-extern ButtonState buttons;
-
-// Gripping state
-extern GrippingMode gripping_mode;
-extern int servo_position;
-extern unsigned long last_reaction_time;
-extern unsigned long last_slip_or_entry_time;
-extern unsigned long last_backoff_time;
-
-// Slip detection
-extern bool slip_flag;
-extern float slip_indicator;
-extern bool new_slip_data_ready;
-
-// FFT instances
-extern AxisFFT fftX_high_pass;
-extern AxisFFT fftY_high_pass;
-extern AxisFFT fftZ_high_pass;
-extern AxisFFT fftMagnitude_high_pass;
-extern AxisFFT fftX_low_pass;
-extern AxisFFT fftY_low_pass;
-extern AxisFFT fftZ_low_pass;
-extern AxisFFT fftMagnitude_low_pass;
-
-// Debug data (volatile for ISR safety)
-extern volatile DebugData debugData;
+// Debug data (written by Core 1 every cycle, read by Core 0 without locking)
+extern Seqlock<DebugData> debugData;
+extern std::atomic<bool> fftReadyToPrint;
 
 // FreeRTOS synchronization
-extern SemaphoreHandle_t mutexSlipData;
-extern SemaphoreHandle_t mutexFFTData;
 extern SemaphoreHandle_t mutexI2C; // I2C Bus Mutex
-extern volatile SemaphoreHandle_t timerSemaphore;
-extern portMUX_TYPE timerMux;
 
-// Debug task handle
+// Task handles
 extern TaskHandle_t debugTaskHandle;
+extern TaskHandle_t controlTaskHandle; // Notified by the timer ISR every scan cycle
 
 // Timer
 extern hw_timer_t* timer;
@@ -0,0 +1,53 @@
+#include "BootTimeline.h"
+#include <atomic>
+
+namespace BootTimeline {
+
+  struct Phase {
+    const char* name;
+    uint32_t start_us;
+    uint32_t end_us;   // 0 while the phase is still running
+    uint8_t core;
+  };
+
+  static Phase phases[BOOT_TIMELINE_CAPACITY];
+  static std::atomic<uint32_t> claimed(0);  // Slots handed out (may exceed the capacity)
+  static uint32_t readyUs = 0;
+
+  int begin(const char* name) {
+    uint32_t slot = claimed.fetch_add(1, std::memory_order_relaxed);
+    if (slot >= BOOT_TIMELINE_CAPACITY) return -1;
+    phases[slot].name = name;
+    phases[slot].core = (uint8_t)xPortGetCoreID();
+    phases[slot].end_us = 0;
+    phases[slot].start_us = micros();
+    return (int)slot;
+  }
+
+  void end(int slot) {
+    if (slot < 0) return;
+    phases[slot].end_us = micros();
+  }
+
+  void markReady() {
+    readyUs = micros();
+  }
+
+  void printReport(Print& out) {
+    uint32_t total = claimed.load(std::memory_order_relaxed);
+    uint32_t count = total < BOOT_TIMELINE_CAPACITY ? total : BOOT_TIMELINE_CAPACITY;
+    uint32_t busy[2] = {0, 0};
+
+    out.printf("{\"type\":\"boot\",\"ready_us\":%lu,\"phases\":[", (unsigned long)readyUs);
+    for (uint32_t i = 0; i < count; i++) {
+      const Phase& p = phases[i];
+      // A phase that has not ended yet (e.g. homing) reports dur -1
+      long dur = p.end_us != 0 ? (long)(p.end_us - p.start_us) : -1;
+      if (dur > 0 && p.core < 2) busy[p.core] += dur;
+      out.printf("%s{\"name\":\"%s\",\"core\":%u,\"start\":%lu,\"dur\":%ld}",
+                 i == 0 ? "" : ",", p.name, (unsigned)p.core, (unsigned long)p.start_us, dur);
+    }
+    out.printf("],\"busy_us\":[%lu,%lu],\"dropped\":%lu}",
+               (unsigned long)busy[0], (unsigned long)busy[1], (unsigned long)(total - count));
+  }
+}
@@ -0,0 +1,27 @@
+#ifndef BOOT_TIMELINE_H
+#define BOOT_TIMELINE_H
+
+#include <Arduino.h>
+#include "../Config.h"
+
+// ============================================
+// BOOT TIMELINE
+// Timestamped init phases from both cores, kept after boot for the
+// {"boot": true} report. Phases may be opened concurrently.
+// ============================================
+
+namespace BootTimeline {
+  // Open a phase on the calling core; returns its slot (-1 if the timeline is full)
+  int begin(const char* name);
+
+  // Close a phase opened by begin()
+  void end(int slot);
+
+  // Mark "System Ready" (end of the critical path)
+  void markReady();
+
+  // Print all phases as one JSON object (times in µs since boot)
+  void printReport(Print& out);
+}
+
+#endif // BOOT_TIMELINE_H
@@ -1,11 +1,24 @@
 #include "DebugTask.h"
 #include "FFTProcessor.h"
+#include "FFTChannels.h"
+#include "TimingMonitor.h"
+#include "Scheduler.h"
+#include "SampleRing.h"
+#include "../Drivers/MagneticSensor.h"
+#include "../Drivers/I2CBus.h"
+#include "../Drivers/MotorDriver.h"
+#include "OnlineCalibration.h"
+#include "BootTimeline.h"
+#include "Experiment.h"
 #include <Arduino.h>
 
 namespace DebugTask {
   
   DebugConfig config;
 
+  // Total seqlock read retries (reader raced a Core 1 update)
+  static uint32_t snapshotRetries = 0;
+
   // Custom Buffered Print class to calculate checksum on the fly and minimize Serial calls
   class ChecksumBufferedSerial : public Print {
   public:
@@ -45,18 +58,19 @@ namespace DebugTask {
       }
   };
 
-  void init() {
-    // Initialize mutexes
-    mutexSlipData = xSemaphoreCreateMutex();
-    if (mutexSlipData == NULL) {
-      Serial.println("[DEBUG] ERROR: Failed to create mutex for slip data!");
-    }
-    
-    mutexFFTData = xSemaphoreCreateMutex();
-    if (mutexFFTData == NULL) {
-      Serial.println("[DEBUG] ERROR: Failed to create mutex for FFT data!");
+  // Run a burst of flash-resident formatting code to evict cache lines
+  // while the control task runs (measures HOT_PATH_IN_IRAM benefit)
+  static void runCacheStress() {
+    char scratch[64];
+    volatile size_t sink = 0;
+    for (int i = 0; i < 200; i++) {
+      sink += snprintf(scratch, sizeof(scratch), "%.3f %ld %e", i * 0.123, (long)i * 7919, i * 1.5e-3);
+      sink += strtol(scratch + 6, NULL, 10);
     }
-    
+    (void)sink;
+  }
+
+  void init() {
     // Create debug task on Core 0
     xTaskCreatePinnedToCore(
       taskFunction,
@@ -71,38 +85,40 @@ namespace DebugTask {
     Serial.println("[DEBUG] ✓ Debug print task started on Core 0");
   }
   
-  void updateData() {
-    // Update shared debug data with mutex protection
-    // This is called from the main loop (Core 1)
-    if (mutexSlipData != NULL && xSemaphoreTake(mutexSlipData, pdMS_TO_TICKS(2)) == pdTRUE) {
-      debugData.slip_flag = slip_flag;
-      debugData.slip_indicator = slip_indicator;
-      
-      debugData.mag_x = magData.x;
-      debugData.mag_y = magData.y;
-      debugData.mag_z = magData.z;
-      debugData.mag_magnitude = magData.magnitude;
-      
-      debugData.mag_x_filtered = magData.x_low_pass;
-      debugData.mag_y_filtered = magData.y_low_pass;
-      debugData.mag_z_filtered = magData.z_low_pass;
+  void HOT_PATH updateData(const ControlState& state) {
+    // Publish shared debug data through the seqlock (never blocks)
+    // This is called from the control task (Core 1)
+    DebugData snapshot;
+    snapshot.control = state;
+    
+    snapshot.scan_time_us = TimingMonitor::lastExecTimeUs(); 
+    snapshot.scan_time_exceeded = TimingMonitor::lastCycleOverran();
+    snapshot.wake_latency_us = TimingMonitor::lastWakeLatencyUs();
+    snapshot.timing_fault = TimingMonitor::isFaulted();
+    snapshot.i2c_healthy = I2CBus::isHealthy();
+    
+    debugData.write(snapshot);
+  }
 
-      debugData.mag_x_high_pass = magData.x_high_pass;
-      debugData.mag_y_high_pass = magData.y_high_pass;
-      debugData.mag_z_high_pass = magData.z_high_pass;
-      
-      debugData.current_mA = current_mA;
-      debugData.servo_position = servo_position;
-      debugData.gripping_mode = (int)gripping_mode;
-      
-      debugData.scan_time_us = measuredInterval; 
-      
-      xSemaphoreGive(mutexSlipData);
+  // Parse up to maxCount comma-separated numbers after `key` (which ends in '[').
+  // Returns the number parsed, or -1 if the key is not in the line.
+  static int parseFloatArray(const String& line, const char* key, float* out, int maxCount) {
+    int at = line.indexOf(key);
+    if (at < 0) return -1;
+    const char* p = line.c_str() + at + strlen(key);
+    int parsed = 0;
+    for (; parsed < maxCount; parsed++) {
+      char* end;
+      float value = strtof(p, &end);
+      if (end == p) break;
+      out[parsed] = value;
+      p = (*end == ',') ? end + 1 : end;
     }
+    return parsed;
   }
 
   void processSerialInput() {
-    static char cmdBuffer[64];
+    static char cmdBuffer[DEBUG_CMD_BUFFER_SIZE];
     static int cmdIndex = 0;
     
     while (Serial.available()) {
@@ -136,6 +152,20 @@ namespace DebugTask {
             commandFound = true;
           }
 
+          // Toggle lossless capture (Exclusive mode)
+          if (line.indexOf("\"capture\":true") >= 0) {
+            config.stream_capture = true;
+            SampleRing::setEnabled(true);
+            Serial.println("{\"status\":\"CAPTURE_ENABLED\"}");
+            commandFound = true;
+          }
+          else if (line.indexOf("\"capture\":false") >= 0) {
+            SampleRing::setEnabled(false);
+            config.stream_capture = false;
+            Serial.println("{\"status\":\"CAPTURE_DISABLED\"}");
+            commandFound = true;
+          }
+
           if (line.indexOf("\"mag_raw\":true") >= 0) { config.stream_mag_raw = true; commandFound = true; }
           if (line.indexOf("\"mag_raw\":false") >= 0) { config.stream_mag_raw = false; commandFound = true; }
 
@@ -163,6 +193,108 @@ namespace DebugTask {
           if (line.indexOf("\"system\":true") >= 0) { config.stream_system = true; commandFound = true; }
           if (line.indexOf("\"system\":false") >= 0) { config.stream_system = false; commandFound = true; }
 
+          // One-shot timing report (jitter/latency/exec histograms)
+          if (line.indexOf("\"timing\":true") >= 0) { config.print_timing = true; commandFound = true; }
+          if (line.indexOf("\"timing_reset\":true") >= 0) { 
+            TimingMonitor::reset(); 
+            Serial.println("{\"status\":\"TIMING_RESET\"}");
+            commandFound = true; 
+          }
+
+          if (line.indexOf("\"cache_stress\":true") >= 0) { config.cache_stress = true; commandFound = true; }
+          if (line.indexOf("\"cache_stress\":false") >= 0) { config.cache_stress = false; commandFound = true; }
+
+          // One-shot per-task execution time report
+          if (line.indexOf("\"sched\":true") >= 0) { config.print_sched = true; commandFound = true; }
+          if (line.indexOf("\"sched_reset\":true") >= 0) { 
+            Scheduler::resetStats(); 
+            Serial.println("{\"status\":\"SCHED_RESET\"}");
+            commandFound = true; 
+          }
+
+          // Boot-time library vs direct read comparison
+          if (line.indexOf("\"mag_read\":true") >= 0) { config.print_mag_read = true; commandFound = true; }
+
+          // Per-device bus latency and deferral counters
+          if (line.indexOf("\"i2c\":true") >= 0) { config.print_i2c = true; commandFound = true; }
+          if (line.indexOf("\"i2c_reset\":true") >= 0) { 
+            I2CBus::resetStats(); 
+            Serial.println("{\"status\":\"I2C_RESET\"}");
+            commandFound = true; 
+          }
+
+          // Online magnetic zero calibration
+          if (line.indexOf("\"calib\":true") >= 0) { config.print_calib = true; commandFound = true; }
+          if (line.indexOf("\"recalibrate\":true") >= 0) { 
+            OnlineCalibration::requestRecalibration(); 
+            Serial.println("{\"status\":\"RECALIBRATING\"}");
+            commandFound = true; 
+          }
+          // Boot timeline (init phases of both cores)
+          if (line.indexOf("\"boot\":true") >= 0) { config.print_boot = true; commandFound = true; }
+
+          // FFT window rate per channel (slip windows must arrive at fs / FFT_SAMPLES)
+          if (line.indexOf("\"fft_rate\":true") >= 0) { config.print_fft_rate = true; commandFound = true; }
+
+          // TMC2209 register shadow / UART task
+          if (line.indexOf("\"tmc\":true") >= 0) { config.print_tmc = true; commandFound = true; }
+
+          // Lift homing (otherwise skipped at boot while the stored position is valid)
+          if (line.indexOf("\"home\":true") >= 0) {
+            Serial.println(MotorDriver::requestHoming() ? "{\"status\":\"HOMING\"}" : "{\"status\":\"HOMING_BUSY\"}");
+            commandFound = true;
+          }
+
+          // Row-major 3x3 from software/fit_calibration.py, stored in NVS
+          float m[9];
+          int parsed = parseFloatArray(line, "\"calmatrix\":[", m, 9);
+          if (parsed >= 0) {
+            if (parsed == 9 && OnlineCalibration::setMatrix(m, true)) {
+              Serial.println("{\"status\":\"CALMATRIX_STORED\"}");
+            } else {
+              Serial.println("{\"status\":\"CALMATRIX_INVALID\"}");
+            }
+            commandFound = true;
+          }
+
+          // Queued lift move: [pos_mm, speed_mm_s, accel_mm_s2, start_stop_jerk_mm_s3], trailing values optional
+          float lift[4] = {0.0f, LIFT_MAX_SPEED_MM_S, LIFT_DEFAULT_ACCEL_MM_S2, LIFT_DEFAULT_START_STOP_JERK_MM_S3};
+          parsed = parseFloatArray(line, "\"lift\":[", lift, 4);
+          if (parsed >= 0) {
+            bool ok = parsed >= 1 && MotorDriver::queueSegment({lift[0], lift[1], lift[2], lift[3]});
+            Serial.println(ok ? "{\"status\":\"LIFT_QUEUED\"}" : "{\"status\":\"LIFT_REJECTED\"}");
+            commandFound = true;
+          }
+          if (line.indexOf("\"lift_stop\":true") >= 0) {
+            MotorDriver::clearMotionQueue();
+            Serial.println("{\"status\":\"LIFT_STOPPED\"}");
+            commandFound = true;
+          }
+
+          // Scripted experiment batches (records arrive as "trial" objects)
+          int scriptStart = line.indexOf("\"exp_script\":\"");
+          if (scriptStart >= 0) {
+            scriptStart += 14;
+            int scriptEnd = line.indexOf('"', scriptStart);
+            bool ok = scriptEnd > scriptStart &&
+                      Experiment::loadScript(line.substring(scriptStart, scriptEnd).c_str());
+            Serial.println(ok ? "{\"status\":\"SCRIPT_OK\"}" : "{\"status\":\"SCRIPT_INVALID\"}");
+            commandFound = true;
+          }
+          int runStart = line.indexOf("\"exp_run\":");
+          if (runStart >= 0) {
+            long trials = line.substring(runStart + 10).toInt();
+            bool ok = trials > 0 && trials <= UINT16_MAX && Experiment::start((uint16_t)trials);
+            Serial.println(ok ? "{\"status\":\"EXP_STARTED\"}" : "{\"status\":\"EXP_BUSY\"}");
+            commandFound = true;
+          }
+          if (line.indexOf("\"exp_stop\":true") >= 0) {
+            Experiment::stop();
+            Serial.println("{\"status\":\"EXP_STOPPING\"}");
+            commandFound = true;
+          }
+          if (line.indexOf("\"exp_status\":true") >= 0) { config.print_exp = true; commandFound = true; }
+
           // Ack for other commands to verify reception
           if (commandFound && !config.stream_fft) { 
              // Serial.println("{\"status\":\"CMD_OK\"}");
@@ -173,55 +305,161 @@ namespace DebugTask {
           }
         }
       } else {
-        if (cmdIndex < 63) {
+        if (cmdIndex < (int)DEBUG_CMD_BUFFER_SIZE - 1) {
           cmdBuffer[cmdIndex++] = c;
         }
       }
     }
   }
   
+  // A flash write stalls the cache of both cores, so the scan cycle loses ticks while it
+  // runs. Writes are only made with the gripper OPEN; each one is timed for the timing report.
+  static void servicePersistence(DebugData& snapshot) {
+    snapshotRetries += debugData.read(snapshot);
+    const bool gripperOpen = snapshot.control.gripping_mode == GRIPPING_MODE_OPEN;
+
+    uint32_t lostBefore = TimingMonitor::lostCycles();
+    uint32_t start = micros();
+    bool wrote = OnlineCalibration::servicePersistence(gripperOpen);
+    wrote |= MotorDriver::servicePersistence(gripperOpen);
+    if (!wrote) return;
+
+    uint32_t duration = micros() - start;
+    // Missed ticks are counted at the next cycle start; let it run first
+    vTaskDelay(1);
+    TimingMonitor::recordFlashWrite(duration, TimingMonitor::lostCycles() - lostBefore);
+  }
+
   void taskFunction(void* parameter) {
     // TickType_t xLastWakeTime = xTaskGetTickCount(); // Not used for simple Delay
     const TickType_t xFrequency = pdMS_TO_TICKS(DEBUG_PRINT_INTERVAL_MS);
     
     DebugData localData;
     ChecksumBufferedSerial chkSerial;
+    SampleRecord records[SAMPLE_RING_BATCH];
     
     for (;;) {
       // Check for commands
       processSerialInput();
 
-      if (config.stream_fft) {
+      // NVS writes stay on this core, never in the control task
+      servicePersistence(localData);
+
+      if (config.cache_stress) {
+        runCacheStress();
+      }
+
+      if (config.print_timing) {
+        config.print_timing = false;
+        chkSerial.reset();
+        TimingMonitor::printReport(chkSerial);
+        chkSerial.flush();
+      }
+
+      if (config.print_sched) {
+        config.print_sched = false;
+        chkSerial.reset();
+        Scheduler::printReport(chkSerial);
+        chkSerial.flush();
+      }
+
+      if (config.print_mag_read) {
+        config.print_mag_read = false;
+        chkSerial.reset();
+        MagneticSensor::printReadReport(chkSerial);
+        chkSerial.flush();
+      }
+
+      if (config.print_i2c) {
+        config.print_i2c = false;
+        chkSerial.reset();
+        I2CBus::printReport(chkSerial);
+        chkSerial.flush();
+      }
+
+      if (config.print_calib) {
+        config.print_calib = false;
+        chkSerial.reset();
+        OnlineCalibration::printReport(chkSerial);
+        chkSerial.flush();
+      }
+
+      if (config.print_fft_rate) {
+        config.print_fft_rate = false;
+        chkSerial.reset();
+        FFTProcessor::printRateReport(chkSerial);
+        chkSerial.flush();
+      }
+
+      if (config.print_boot) {
+        config.print_boot = false;
+        chkSerial.reset();
+        BootTimeline::printReport(chkSerial);
+        chkSerial.flush();
+      }
+
+      if (config.print_tmc) {
+        config.print_tmc = false;
+        chkSerial.reset();
+        MotorDriver::printReport(chkSerial);
+        chkSerial.flush();
+      }
+
+      if (config.print_exp) {
+        config.print_exp = false;
+        chkSerial.reset();
+        Experiment::printReport(chkSerial);
+        chkSerial.flush();
+      }
+
+      Experiment::TrialRecord trial;
+      while (Experiment::popRecord(trial)) {
+        chkSerial.reset();
+        Experiment::printRecord(chkSerial, trial);
+        chkSerial.flush();
+      }
+
+      if (config.stream_capture) {
+        // EXCLUSIVE CAPTURE MODE - drain the ring in bursts
+        size_t count;
+        while ((count = SampleRing::drain(records, SAMPLE_RING_BATCH)) > 0) {
+          chkSerial.reset();
+          chkSerial.printf("{\"type\":\"cap\",\"ovf\":%lu,\"d\":[", (unsigned long)SampleRing::overflowCount());
+          for (size_t i = 0; i < count; i++) {
+            const SampleRecord& r = records[i];
+            chkSerial.printf("%s[%lu,%lu,%.2f,%.2f,%.2f,%.2f,%.2f,%.2f,%.1f,%d,%u,%u]",
+                i == 0 ? "" : ",", (unsigned long)r.seq, (unsigned long)r.timestamp_us,
+                r.raw_x, r.raw_y, r.raw_z, r.mag_x_high_pass, r.mag_y_high_pass, r.mag_z_high_pass,
+                r.current_mA, r.servo_position, r.gripping_mode, r.slip_flag);
+          }
+          chkSerial.print("]}");
+          chkSerial.flush();
+        }
+        
+        // Let the ring refill
+        vTaskDelay(1);
+      }
+      else if (config.stream_fft) {
         // EXCLUSIVE FFT MODE
         
-        bool local_fft_ready = false;
-        if (mutexSlipData != NULL && xSemaphoreTake(mutexSlipData, pdMS_TO_TICKS(10)) == pdTRUE) {
-             local_fft_ready = debugData.fft_ready_to_print;
-             if (local_fft_ready) debugData.fft_ready_to_print = false;
-             xSemaphoreGive(mutexSlipData);
-        }
+        bool local_fft_ready = fftReadyToPrint.exchange(false);
+        AxisFFT& streamFFT = FFTChannels::get(STREAM_FFT_CHANNEL);
 
-        if (local_fft_ready) {
-           // We need to access the FFT arrays which are global
-           
-           if (mutexFFTData != NULL && xSemaphoreTake(mutexFFTData, pdMS_TO_TICKS(50)) == pdTRUE) {
-              
-              chkSerial.reset();
-              chkSerial.print("{\"type\":\"fft\",\"data\":[");
-              for(int i=0; i<FFT_SAMPLES/2; i++) { // Only first half is useful usually
-                 chkSerial.print(fftX_high_pass.vReal[i], 2); 
-                 if(i < (FFT_SAMPLES/2)-1) chkSerial.print(",");
-              }
-              chkSerial.print("]}");
-              
-              chkSerial.flush();
-              
-              // Reset flag in FFT processor
-              fftX_high_pass.FFT_complete = false;
-              fftX_high_pass.index = 0;
-              
-              xSemaphoreGive(mutexFFTData);
+        // While FFT_complete is set the FFT arrays belong to this task
+        if (local_fft_ready && streamFFT.FFT_complete) {
+           chkSerial.reset();
+           chkSerial.print("{\"type\":\"fft\",\"data\":[");
+           for(int i=0; i<FFT_SAMPLES/2; i++) { // Only first half is useful usually
+              chkSerial.print(streamFFT.vReal[i], 2); 
+              if(i < (FFT_SAMPLES/2)-1) chkSerial.print(",");
            }
+           chkSerial.print("]}");
+           
+           chkSerial.flush();
+           
+           // Hand the arrays back to the FFT processor
+           streamFFT.index = 0;
+           streamFFT.FFT_complete = false;
         }
         
         // Yield to allow other tasks
@@ -232,13 +470,8 @@ namespace DebugTask {
         // Use vTaskDelay instead of vTaskDelayUntil to prevent buffer saturation if lagging
         vTaskDelay(xFrequency);
         
-        // Copy shared data
-        if (mutexSlipData != NULL && xSemaphoreTake(mutexSlipData, pdMS_TO_TICKS(10)) == pdTRUE) {
-          localData = const_cast<DebugData&>(debugData);
-          xSemaphoreGive(mutexSlipData);
-        } else {
-          continue;
-        }
+        // Copy shared data (retries instead of locking out the writer)
+        snapshotRetries += debugData.read(localData);
 
         // Build JSON String
         chkSerial.reset();
@@ -248,45 +481,48 @@ namespace DebugTask {
         if (config.stream_mag_filtered) {
            if(!first) chkSerial.print(",");
            chkSerial.printf("\"mlx\":%.2f,\"mly\":%.2f,\"mlz\":%.2f,\"mag\":%.2f", 
-              localData.mag_x_filtered, localData.mag_y_filtered, localData.mag_z_filtered, localData.mag_magnitude);
+              localData.control.mag.x_low_pass, localData.control.mag.y_low_pass, localData.control.mag.z_low_pass, localData.control.mag.magnitude);
            first = false;
         }
 
         if (config.stream_mag_highpass) {
            if(!first) chkSerial.print(",");
            chkSerial.printf("\"mhx\":%.2f,\"mhy\":%.2f,\"mhz\":%.2f", 
-              localData.mag_x_high_pass, localData.mag_y_high_pass, localData.mag_z_high_pass);
+              localData.control.mag.x_high_pass, localData.control.mag.y_high_pass, localData.control.mag.z_high_pass);
            first = false;
         }
 
         if (config.stream_mag_raw) {
            if(!first) chkSerial.print(",");
            chkSerial.printf("\"rmx\":%.2f,\"rmy\":%.2f,\"rmz\":%.2f", 
-              localData.mag_x, localData.mag_y, localData.mag_z);
+              localData.control.mag.x, localData.control.mag.y, localData.control.mag.z);
            first = false;
         }
 
         if (config.stream_current) {
            if(!first) chkSerial.print(",");
-           chkSerial.printf("\"cur\":%.2f", localData.current_mA);
+           chkSerial.printf("\"cur\":%.2f", localData.control.current_mA);
            first = false;
         }
         
         if (config.stream_slip) {
            if(!first) chkSerial.print(",");
-           chkSerial.printf("\"slip\":%d,\"s_ind\":%.2f", localData.slip_flag ? 1 : 0, localData.slip_indicator);
+           chkSerial.printf("\"slip\":%d,\"s_ind\":%.2f", localData.control.slip_flag ? 1 : 0, localData.control.slip_indicator);
            first = false;
         }
 
         if (config.stream_servo) {
            if(!first) chkSerial.print(",");
-           chkSerial.printf("\"srv\":%d,\"grp\":%d", localData.servo_position, localData.gripping_mode);
+           chkSerial.printf("\"srv\":%d,\"grp\":%d", localData.control.servo_position, (int)localData.control.gripping_mode);
            first = false;
         }
 
         if (config.stream_system) {
            if(!first) chkSerial.print(",");
-           chkSerial.printf("\"t\":%lu", localData.scan_time_us);
+           chkSerial.printf("\"t\":%lu,\"lat\":%lu,\"ovr\":%d,\"tf\":%d,\"rr\":%lu,\"bus\":%d", 
+              localData.scan_time_us, localData.wake_latency_us, 
+              localData.scan_time_exceeded ? 1 : 0, localData.timing_fault ? 1 : 0,
+              (unsigned long)snapshotRetries, localData.i2c_healthy ? 1 : 0);
            first = false;
         }
 
@@ -18,7 +18,18 @@ namespace DebugTask {
     bool stream_servo = false;
     bool stream_slip = false;
     bool stream_fft = false; // Exclusive mode
+    bool stream_capture = false; // Exclusive mode, lossless full-rate records
     bool stream_system = false; // Scan time, mode
+    bool print_timing = false; // One-shot timing report request
+    bool print_sched = false; // One-shot scheduler report request
+    bool print_mag_read = false; // One-shot magnetic read path comparison
+    bool print_i2c = false; // One-shot I2C bus scheduler report
+    bool print_calib = false; // One-shot online calibration report
+    bool print_boot = false; // One-shot boot timeline
+    bool print_fft_rate = false; // One-shot FFT windows-per-second check
+    bool print_tmc = false; // One-shot TMC2209 UART/shadow report
+    bool print_exp = false; // One-shot experiment batch status
+    bool cache_stress = false; // Thrash the flash cache from Core 0 (hot path placement test)
   };
 
   extern DebugConfig config;
@@ -26,8 +37,8 @@ namespace DebugTask {
   // Initialize and start the debug task on Core 0
   void init();
   
-  // Update shared debug data (called from main loop)
-  void updateData();
+  // Publish the control state and timing data (called from the control task)
+  void updateData(const ControlState& state);
   
   // Task function (runs on Core 0)
   void taskFunction(void* parameter);
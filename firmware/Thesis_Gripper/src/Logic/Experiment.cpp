@@ -0,0 +1,319 @@
+#include "Experiment.h"
+#include "../Globals.h"
+#include "../Drivers/Buttons.h"
+#include "../Drivers/MotorDriver.h"
+#include <atomic>
+
+namespace Experiment {
+
+  enum StepType : uint8_t { STEP_GRASP, STEP_WAIT_HOLDING, STEP_LIFT, STEP_HOLD, STEP_OPEN };
+
+  struct Step {
+    StepType type;
+    float value;   // Lift target (mm) or hold time (s)
+    float speed;   // Lift speed (mm/s)
+  };
+
+  static const char* const resultNames[] = {"ok", "not_ready", "grasp_timeout", "hold_timeout",
+                                            "lift_timeout", "open_timeout", "lost", "aborted"};
+
+  // Script (written by the debug task only while idle)
+  static Step steps[EXP_MAX_STEPS];
+  static uint8_t stepCount = 0;
+  static char scriptText[EXP_SCRIPT_MAX_LEN] = "";
+
+  static TaskHandle_t taskHandle = NULL;
+  static QueueHandle_t records = NULL;
+  static std::atomic<bool> running(false);
+  static std::atomic<bool> stopRequested(false);
+
+  // Batch progress (written by the engine task)
+  static volatile uint16_t trialsRequested = 0;
+  static volatile uint16_t trialsDone = 0;
+  static volatile uint16_t trialsOk = 0;
+  static volatile uint32_t recordsDropped = 0;
+
+  // ------------------------------------------------------------------
+  // Observation of the published control state
+  // ------------------------------------------------------------------
+
+  static ControlState observed;
+  static GrippingMode lastMode = GRIPPING_MODE_OPEN;
+  static uint16_t reactionsAtStart = 0;
+
+  static inline bool isHeld(GrippingMode mode) {
+    return mode == GRIPPING_MODE_HOLDING || mode == GRIPPING_MODE_REACTING;
+  }
+
+  static bool isReleasing() {
+    return observed.gripping_mode == GRIPPING_MODE_OPENING || observed.gripping_mode == GRIPPING_MODE_OPEN;
+  }
+
+  // Sample once and update the trial statistics
+  static void observe(TrialRecord& rec) {
+    DebugData data;
+    debugData.read(data);
+    observed = data.control;
+
+    const GrippingMode mode = observed.gripping_mode;
+    if (isHeld(lastMode) && mode == GRIPPING_MODE_GRASPING) rec.regrasps++;
+    if (isHeld(mode) && observed.mag.magnitude < rec.mag_min) rec.mag_min = observed.mag.magnitude;
+    if (observed.current_mA > rec.current_max_mA) rec.current_max_mA = observed.current_mA;
+    rec.reactions = (uint16_t)(observed.slip_reactions - reactionsAtStart);
+    lastMode = mode;
+  }
+
+  // Poll until `done` holds; false on timeout or stop request
+  template <typename Predicate>
+  static bool waitFor(TrialRecord& rec, uint32_t timeoutMs, Predicate done) {
+    uint32_t start = millis();
+    for (;;) {
+      observe(rec);
+      if (done()) return true;
+      if (stopRequested.load() || millis() - start >= timeoutMs) return false;
+      vTaskDelay(pdMS_TO_TICKS(EXP_POLL_MS));
+    }
+  }
+
+  // ------------------------------------------------------------------
+  // Steps
+  // ------------------------------------------------------------------
+
+  // Press a virtual button until the FSM has reacted to it
+  template <typename Predicate>
+  static bool press(TrialRecord& rec, uint8_t mask, Predicate reacted) {
+    Buttons::setVirtual(mask);
+    bool ok = waitFor(rec, EXP_STEP_TIMEOUT_MS, reacted);
+    Buttons::setVirtual(0);
+    return ok;
+  }
+
+  static TrialResult runStep(TrialRecord& rec, const Step& step, uint32_t trialStart) {
+    switch (step.type) {
+      case STEP_GRASP:
+        if (!press(rec, Buttons::MASK_GRASP, [] { return observed.gripping_mode != GRIPPING_MODE_OPEN; })) {
+          return TRIAL_GRASP_TIMEOUT;
+        }
+        return TRIAL_OK;
+
+      case STEP_WAIT_HOLDING:
+        if (!waitFor(rec, EXP_STEP_TIMEOUT_MS, [] { return isHeld(observed.gripping_mode); })) {
+          return TRIAL_HOLD_TIMEOUT;
+        }
+        if (rec.grasp_ms == 0) {
+          rec.grasp_ms = millis() - trialStart;
+          rec.servo_hold = observed.servo_position;
+          rec.mag_hold = observed.mag.magnitude;
+        }
+        return TRIAL_OK;
+
+      case STEP_LIFT: {
+        float distance = fabsf(step.value - MotorDriver::getPosition() / TMC_STEPS_PER_MM);
+        uint32_t timeoutMs = (uint32_t)(1000.0f * distance / step.speed) + EXP_LIFT_TIMEOUT_MARGIN_MS;
+        if (!MotorDriver::queueSegment({step.value, step.speed, LIFT_DEFAULT_ACCEL_MM_S2, LIFT_DEFAULT_START_STOP_JERK_MM_S3})) {
+          return TRIAL_LIFT_TIMEOUT;
+        }
+        if (!waitFor(rec, timeoutMs, [] { return MotorDriver::isMotionIdle(); })) {
+          return TRIAL_LIFT_TIMEOUT;
+        }
+        return TRIAL_OK;
+      }
+
+      case STEP_HOLD:
+        waitFor(rec, (uint32_t)(step.value * 1000.0f), [] { return false; });
+        // The object has to survive the hold
+        return isHeld(observed.gripping_mode) ? TRIAL_OK : TRIAL_LOST;
+
+      case STEP_OPEN:
+        rec.servo_end = observed.servo_position;
+        if (!press(rec, Buttons::MASK_OPEN, isReleasing) ||
+            !waitFor(rec, EXP_STEP_TIMEOUT_MS, [] { return observed.gripping_mode == GRIPPING_MODE_OPEN; })) {
+          return TRIAL_OPEN_TIMEOUT;
+        }
+        return TRIAL_OK;
+    }
+    return TRIAL_OK;
+  }
+
+  // Leave the rig safe after a failed or aborted trial
+  static void recover(TrialRecord& rec) {
+    Buttons::setVirtual(0);
+    MotorDriver::clearMotionQueue();
+    stopRequested.store(false);  // Let the recovery waits run
+    press(rec, Buttons::MASK_OPEN, isReleasing);
+    waitFor(rec, EXP_STEP_TIMEOUT_MS, [] { return observed.gripping_mode == GRIPPING_MODE_OPEN; });
+    // Back to the bottom so the next trial starts from the same place
+    MotorDriver::queueSegment({0.0f, LIFT_MAX_SPEED_MM_S, LIFT_DEFAULT_ACCEL_MM_S2, LIFT_DEFAULT_START_STOP_JERK_MM_S3});
+  }
+
+  static TrialRecord runTrial(uint16_t index) {
+    TrialRecord rec = {};
+    rec.trial = index;
+    rec.step = 0xFF;
+    rec.mag_min = INFINITY;
+    observe(rec);
+    reactionsAtStart = observed.slip_reactions;
+    lastMode = observed.gripping_mode;
+    rec.reactions = 0;
+
+    const uint32_t trialStart = millis();
+    rec.result = TRIAL_OK;
+
+    // Start from OPEN with a known zero, after the lift and sensor have settled
+    bool ready = waitFor(rec, EXP_STEP_TIMEOUT_MS, [] {
+      return observed.gripping_mode == GRIPPING_MODE_OPEN && observed.calibrated &&
+             MotorDriver::isReferenced() && MotorDriver::isMotionIdle();
+    });
+    if (!ready) {
+      rec.result = TRIAL_NOT_READY;
+    } else {
+      waitFor(rec, EXP_SETTLE_MS, [] { return false; });
+      for (uint8_t i = 0; i < stepCount && rec.result == TRIAL_OK; i++) {
+        rec.result = runStep(rec, steps[i], trialStart);
+        if (rec.result != TRIAL_OK) rec.step = i;
+      }
+    }
+
+    bool aborted = stopRequested.load();
+    if (aborted) rec.result = TRIAL_ABORTED;
+    if (rec.result != TRIAL_OK) recover(rec);
+    if (aborted) stopRequested.store(true);  // Keep the batch stopping after recovery
+
+    rec.duration_ms = millis() - trialStart;
+    if (rec.mag_min == INFINITY) rec.mag_min = 0.0f;
+    return rec;
+  }
+
+  static void taskFunction(void* parameter) {
+    for (;;) {
+      ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+
+      uint8_t failuresInRow = 0;
+      for (uint16_t i = 0; i < trialsRequested && !stopRequested.load(); i++) {
+        TrialRecord rec = runTrial(i);
+        trialsDone = i + 1;
+        if (rec.result == TRIAL_OK) {
+          trialsOk++;
+          failuresInRow = 0;
+        } else {
+          failuresInRow++;
+        }
+        if (xQueueSend(records, &rec, 0) != pdTRUE) recordsDropped++;
+
+        // A rig that keeps failing (object gone, jam) should not run all night
+        if (failuresInRow >= EXP_MAX_CONSECUTIVE_FAILURES) break;
+      }
+
+      Buttons::setVirtual(0);
+      stopRequested.store(false);
+      running.store(false);
+    }
+  }
+
+  // ------------------------------------------------------------------
+  // Public API
+  // ------------------------------------------------------------------
+
+  void init() {
+    records = xQueueCreate(EXP_RECORD_QUEUE_LENGTH, sizeof(TrialRecord));
+    if (records == NULL ||
+        xTaskCreatePinnedToCore(taskFunction, "Experiment", EXPERIMENT_TASK_STACK_SIZE, NULL,
+                                EXPERIMENT_TASK_PRIORITY, &taskHandle, EXPERIMENT_TASK_CORE) != pdPASS) {
+      Serial.println("[EXP] Failed to create experiment task");
+      return;
+    }
+    loadScript(EXP_DEFAULT_SCRIPT);
+    Serial.printf("[EXP] ✓ Ready (script %s)\n", scriptText);
+  }
+
+  bool loadScript(const char* script) {
+    if (running.load() || strlen(script) >= EXP_SCRIPT_MAX_LEN) return false;
+
+    Step parsed[EXP_MAX_STEPS];
+    uint8_t count = 0;
+    const char* p = script;
+    while (*p) {
+      if (count >= EXP_MAX_STEPS) return false;
+      Step& step = parsed[count++];
+      char* end;
+      step.value = 0.0f;
+      step.speed = LIFT_MAX_SPEED_MM_S;
+      switch (*p++) {
+        case 'G': step.type = STEP_GRASP; break;
+        case 'W': step.type = STEP_WAIT_HOLDING; break;
+        case 'O': step.type = STEP_OPEN; break;
+        case 'H':
+          step.type = STEP_HOLD;
+          step.value = strtof(p, &end);
+          // Bounded: the step becomes a millisecond count
+          if (end == p || !(step.value >= 0.0f && step.value <= EXP_MAX_HOLD_S)) return false;
+          p = end;
+          break;
+        case 'L':
+          step.type = STEP_LIFT;
+          step.value = strtof(p, &end);
+          if (end == p || !(step.value >= 0.0f && step.value <= LIFT_TRAVEL_MM)) return false;
+          p = end;
+          if (*p == '@') {
+            p++;
+            step.speed = strtof(p, &end);
+            if (end == p || !(step.speed > 0.0f)) return false;
+            p = end;
+          }
+          // The motion task clamps the same way; the lift timeout must use the real speed
+          if (step.speed > LIFT_MAX_SPEED_MM_S) step.speed = LIFT_MAX_SPEED_MM_S;
+          break;
+        default:
+          return false;
+      }
+      if (*p == ',') p++;
+      else if (*p != '\0') return false;
+    }
+    if (count == 0) return false;
+
+    memcpy(steps, parsed, sizeof(Step) * count);
+    stepCount = count;
+    strncpy(scriptText, script, sizeof(scriptText) - 1);
+    return true;
+  }
+
+  bool start(uint16_t trials) {
+    if (taskHandle == NULL || trials == 0) return false;
+    bool expected = false;
+    if (!running.compare_exchange_strong(expected, true)) return false;
+    trialsRequested = trials;
+    trialsDone = 0;
+    trialsOk = 0;
+    stopRequested.store(false);
+    xTaskNotifyGive(taskHandle);
+    return true;
+  }
+
+  void stop() {
+    if (running.load()) stopRequested.store(true);
+  }
+
+  bool isRunning() {
+    return running.load();
+  }
+
+  bool popRecord(TrialRecord& out) {
+    return records != NULL && xQueueReceive(records, &out, 0) == pdTRUE;
+  }
+
+  void printRecord(Print& out, const TrialRecord& r) {
+    out.printf("{\"type\":\"trial\",\"n\":%u,\"result\":\"%s\",\"step\":%d,\"dur_ms\":%lu,\"grasp_ms\":%lu,"
+               "\"reactions\":%u,\"regrasps\":%u,\"srv_hold\":%d,\"srv_end\":%d,"
+               "\"mag_hold\":%.2f,\"mag_min\":%.2f,\"cur_max\":%.1f}",
+               (unsigned)r.trial, resultNames[r.result], r.step == 0xFF ? -1 : (int)r.step,
+               (unsigned long)r.duration_ms, (unsigned long)r.grasp_ms,
+               (unsigned)r.reactions, (unsigned)r.regrasps, (int)r.servo_hold, (int)r.servo_end,
+               r.mag_hold, r.mag_min, r.current_max_mA);
+  }
+
+  void printReport(Print& out) {
+    out.printf("{\"type\":\"exp\",\"running\":%d,\"script\":\"%s\",\"trials\":%u,\"done\":%u,\"ok\":%u,\"dropped\":%lu}",
+               running.load() ? 1 : 0, scriptText, (unsigned)trialsRequested, (unsigned)trialsDone,
+               (unsigned)trialsOk, (unsigned long)recordsDropped);
+  }
+}
@@ -0,0 +1,65 @@
+#ifndef EXPERIMENT_H
+#define EXPERIMENT_H
+
+#include <Arduino.h>
+#include "../Config.h"
+#include "../Types.h"
+
+// ============================================
+// SCRIPTED EXPERIMENT ENGINE
+// Runs a grasp/lift/hold script for N trials from its own task on Core 0.
+// It drives the gripper through virtual button presses and lift segments
+// and watches the published control state, so the scan cycle is unchanged.
+// One result record per trial is handed to the debug task for printing.
+// ============================================
+
+namespace Experiment {
+  enum TrialResult : uint8_t {
+    TRIAL_OK,             // Still held at the end of the last hold step
+    TRIAL_NOT_READY,      // Gripper not OPEN and calibrated before the trial
+    TRIAL_GRASP_TIMEOUT,  // No contact (GRASPING/HOLDING) after the grasp press
+    TRIAL_HOLD_TIMEOUT,   // HOLDING not reached
+    TRIAL_LIFT_TIMEOUT,   // Lift segment did not finish
+    TRIAL_OPEN_TIMEOUT,   // Gripper did not release / reach OPEN
+    TRIAL_LOST,           // Object not held at the end of the hold
+    TRIAL_ABORTED         // Stopped by command
+  };
+
+  struct TrialRecord {
+    uint16_t trial;
+    TrialResult result;
+    uint8_t step;          // Step that ended the trial early (0xFF = completed)
+    uint32_t duration_ms;
+    uint32_t grasp_ms;     // Grasp press -> HOLDING
+    uint16_t reactions;    // Slip reactions during the trial
+    uint16_t regrasps;     // HOLDING -> GRASPING (magnitude dropped)
+    int16_t servo_hold;    // Servo position when HOLDING was reached
+    int16_t servo_end;     // Servo position before opening
+    float mag_hold;        // Magnitude when HOLDING was reached
+    float mag_min;         // Lowest magnitude while held
+    float current_max_mA;  // Peak servo current
+  };
+
+  // Create the engine task (idle until start)
+  void init();
+
+  // Load a script such as "G,W,L50@2,H5,L0@2,O"; false if it does not parse
+  bool loadScript(const char* script);
+
+  // Start a batch of trials; false if one is already running
+  bool start(uint16_t trials);
+
+  // Abort the batch: release buttons, stop the lift, open the gripper
+  void stop();
+
+  bool isRunning();
+
+  // Debug task: take the next finished trial record
+  bool popRecord(TrialRecord& out);
+
+  // Print one trial record / the batch status as one JSON object
+  void printRecord(Print& out, const TrialRecord& record);
+  void printReport(Print& out);
+}
+
+#endif // EXPERIMENT_H
@@ -0,0 +1,50 @@
+#include "FFTChannels.h"
+#include <Arduino.h>
+
+namespace FFTChannels {
+
+  static double arena[FFT_ARENA_BYTES / sizeof(double)];
+  static AxisFFT channels[FFT_CHANNEL_COUNT];
+
+  // Indexed by FFTChannelSource
+  static float MagneticData::* const HOT_DATA sourceFields[] = {
+    &MagneticData::x_high_pass,
+    &MagneticData::y_high_pass,
+    &MagneticData::z_high_pass,
+    &MagneticData::magnitude_high_pass,
+    &MagneticData::x_low_pass,
+    &MagneticData::y_low_pass,
+    &MagneticData::z_low_pass,
+    &MagneticData::magnitude_low_pass,
+  };
+  static_assert(sizeof(sourceFields) / sizeof(sourceFields[0]) == FFT_SOURCE_MAGNITUDE_LOW_PASS + 1,
+                "sourceFields must cover every FFTChannelSource");
+
+  void init() {
+    for (size_t i = 0; i < FFT_CHANNEL_COUNT; i++) {
+      double* real = &arena[(2 * i) * FFT_SAMPLES];
+      double* imag = &arena[(2 * i + 1) * FFT_SAMPLES];
+      channels[i].attach(FFT_CHANNELS[i].name, FFT_CHANNELS[i].source, real, imag);
+    }
+
+    Serial.printf("[FFT] ✓ %u channels, DSP memory %u bytes (arena %u + objects %u, budget %u)\n",
+                  (unsigned)FFT_CHANNEL_COUNT, (unsigned)memoryBytes(), (unsigned)sizeof(arena),
+                  (unsigned)sizeof(channels), (unsigned)DSP_MEMORY_BUDGET_BYTES);
+  }
+
+  size_t count() {
+    return FFT_CHANNEL_COUNT;
+  }
+
+  AxisFFT& get(int index) {
+    return channels[index];
+  }
+
+  float HOT_PATH sourceValue(const MagneticData& data, FFTChannelSource source) {
+    return data.*sourceFields[source];
+  }
+
+  size_t memoryBytes() {
+    return sizeof(arena) + sizeof(channels);
+  }
+}
@@ -0,0 +1,30 @@
+#ifndef FFT_CHANNELS_H
+#define FFT_CHANNELS_H
+
+#include "../Config.h"
+#include "../Types.h"
+
+// ============================================
+// FFT CHANNEL REGISTRY
+// Channels declared in FFT_CHANNELS (Config.h) share one static arena;
+// undeclared signals cost no RAM.
+// ============================================
+
+namespace FFTChannels {
+  // Bind every declared channel to its arena slice and print the memory budget
+  void init();
+
+  // Number of declared channels
+  size_t count();
+
+  // Channel by index (see fftChannelIndex in Config.h)
+  AxisFFT& get(int index);
+
+  // Value of a channel's source signal in a filtered sample
+  float sourceValue(const MagneticData& data, FFTChannelSource source);
+
+  // Total RAM used by the channels (arena + channel objects)
+  size_t memoryBytes();
+}
+
+#endif // FFT_CHANNELS_H
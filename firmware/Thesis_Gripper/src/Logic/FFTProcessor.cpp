@@ -1,55 +1,89 @@
 #include "FFTProcessor.h"
+#include "FFTChannels.h"
+#include "SignalGraph.h"
 #include <Arduino.h>
 
 namespace FFTProcessor {
+
+  // Per channel (control task writes, debug task reads)
+  static uint32_t windows[FFT_CHANNEL_COUNT] = {};
+  static uint32_t dropped[FFT_CHANNEL_COUNT] = {};
   
-  static int counter = 0;
+  // Add one sample to an axis; false if the window is full or still owned by its consumer
+  static bool HOT_PATH pushSample(AxisFFT& axisData, double value) {
+    // Don't add new samples if FFT is complete and waiting to be printed
+    if (axisData.FFT_complete || axisData.index >= FFT_SAMPLES) return false;
+    
+    axisData.vReal[axisData.index] = value;
+    axisData.vImag[axisData.index] = 0;
+    axisData.index++;
+    return true;
+  }
+
+  static inline bool isFull(const AxisFFT& axisData) {
+    return !axisData.FFT_complete && axisData.index >= FFT_SAMPLES;
+  }
+
+  // Transform a full window and hand it to its consumer
+  static void transform(size_t c, AxisFFT& channel) {
+    channel.fft.compute(FFTDirection::Forward);
+    channel.fft.complexToMagnitude();
+    channel.index = 0;
+    channel.FFT_complete = true;
+    windows[c]++;
+  }
   
   bool processSingleAxis(AxisFFT& axisData, double value) {
-    bool justFinished = false;
-    // Protect FFT data access with mutex
-    if (mutexFFTData != NULL && xSemaphoreTake(mutexFFTData, 0) == pdTRUE) {
-      
-      // Don't add new samples if FFT is complete and waiting to be printed
-      if (!axisData.FFT_complete) {
-        if (axisData.index < FFT_SAMPLES) {
-          axisData.vReal[axisData.index] = value;
-          axisData.vImag[axisData.index] = 0;
-          axisData.index++;
-        } else {
-          
-          axisData.fft.compute(FFTDirection::Forward);
-          axisData.fft.complexToMagnitude();
-          axisData.index = 0;
-          axisData.FFT_complete = true;
-          justFinished = true;
-        }
+    pushSample(axisData, value);
+    return isFull(axisData);
+  }
+  
+  void process(const MagneticData& data) {
+    processBlock(&data, 1);
+  }
+  
+  void HOT_PATH processBlock(const MagneticData* block, size_t count) {
+    // Feed every consumed channel from its source signal
+    for (size_t k = 0; k < SignalGraph::LIVE_CHANNELS.count; k++) {
+      const size_t c = SignalGraph::LIVE_CHANNELS.index[k];
+      AxisFFT& channel = FFTChannels::get(c);
+      for (size_t i = 0; i < count; i++) {
+        if (!pushSample(channel, FFTChannels::sourceValue(block[i], channel.source))) dropped[c]++;
       }
-      
-      xSemaphoreGive(mutexFFTData);
+      // Slip detection (same tick) consumes the spectrum before the next sample arrives
+      if ((int)c == SLIP_FFT_CHANNEL && isFull(channel)) transform(c, channel);
     }
-    
-    return justFinished;
   }
   
-  void process(const MagneticData& data) {
-    // Process FFT for high-pass filtered components
-    bool x_complete = processSingleAxis(fftX_high_pass, data.x_high_pass);
-    processSingleAxis(fftY_high_pass, data.y_high_pass);
+  void computeDue() {
+    bool stream_complete = false;
+    
+    for (size_t k = 0; k < SignalGraph::LIVE_CHANNELS.count; k++) {
+      const size_t c = SignalGraph::LIVE_CHANNELS.index[k];
+      if ((int)c == SLIP_FFT_CHANNEL) continue;
+      AxisFFT& channel = FFTChannels::get(c);
+      if (!isFull(channel)) continue;
+      
+      transform(c, channel);
+      if ((int)c == STREAM_FFT_CHANNEL) stream_complete = true;
+    }
     
     // Signal debug task when FFT is ready
-    if (true) {
-      if (x_complete) {
-        counter++;
-        if (counter >= 1) {
-          if (xSemaphoreTake(mutexSlipData, pdMS_TO_TICKS(1)) == pdTRUE) {
-            debugData.fft_ready_to_print = true;
-            xSemaphoreGive(mutexSlipData);
-          }
-          counter = 0;
-        }
-      }
+    if (stream_complete) fftReadyToPrint.store(true);
+  }
+  
+  void printRateReport(Print& out) {
+    const float elapsed_s = millis() / 1000.0f;
+    out.printf("{\"type\":\"fft_rate\",\"elapsed_s\":%.1f,\"expected_hz\":%.2f,\"channels\":[",
+               elapsed_s, MAGNETIC_SENSOR_SAMPLING_FREQUENCY / FFT_SAMPLES);
+    for (size_t k = 0; k < SignalGraph::LIVE_CHANNELS.count; k++) {
+      const size_t c = SignalGraph::LIVE_CHANNELS.index[k];
+      out.printf("%s{\"name\":\"%s\",\"inline\":%d,\"windows\":%lu,\"hz\":%.2f,\"dropped\":%lu}",
+                 k == 0 ? "" : ",", FFT_CHANNELS[c].name, (int)c == SLIP_FFT_CHANNEL ? 1 : 0,
+                 (unsigned long)windows[c], elapsed_s > 0.0f ? windows[c] / elapsed_s : 0.0f,
+                 (unsigned long)dropped[c]);
     }
+    out.print("]}");
   }
   
   void printCombinedFFT(double* lowPass, double* highPass) {
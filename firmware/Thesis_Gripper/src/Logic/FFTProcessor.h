@@ -10,13 +10,22 @@
 // ============================================
 
 namespace FFTProcessor {
-  // Process single axis FFT (DRY principle)
-  // Returns true if FFT computation completed
+  // Add one sample to an axis buffer; returns true once the window is full
   bool processSingleAxis(AxisFFT& axisData, double value);
   
   // Process all axes FFT
   void process(const MagneticData& data);
   
+  // Process all axes FFT for `count` consecutive samples under a single lock
+  void processBlock(const MagneticData* block, size_t count);
+
+  // Transform the full windows of the non-slip channels (scheduler slot FFT_COMPUTE_PHASE /
+  // FFT_COMPUTE_DIVIDER); the slip window is transformed by processBlock when it fills
+  void computeDue();
+
+  // Windows per second and dropped samples per live channel as one JSON object
+  void printRateReport(Print& out);
+  
   // Print combined FFT data (JSON format)
   void printCombinedFFT(double* lowPass, double* highPass);
   
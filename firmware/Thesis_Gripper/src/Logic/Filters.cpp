@@ -1,4 +1,5 @@
 #include "Filters.h"
+#include "SignalGraph.h"
 #include <Arduino.h>
 #include <math.h>
 
@@ -48,35 +49,80 @@ namespace Filters {
     filterCurrentMA.alpha = alphaCurrent;
     
     Serial.println("[FILTERS] ✓ Initialized");
+    Serial.printf("  Sample rate: %.1f Hz (Nyquist %.1f Hz, FFT bin %.2f Hz, slip bins %u-%u)\n",
+                  MAGNETIC_SENSOR_SAMPLING_FREQUENCY, NYQUIST_HZ, FFT_BIN_HZ,
+                  (unsigned)SLIP_START_BIN, (unsigned)SLIP_END_BIN);
     Serial.print("  500Hz alpha: ");
     Serial.println(alpha500Hz, 6);
     Serial.print("  30Hz alpha: ");
     Serial.println(alpha30Hz, 6);
+    Serial.printf("  Block size: %u (added latency %lu us)\n", (unsigned)DSP_BLOCK_SIZE, DSP_BLOCK_LATENCY_US);
+  }
+  
+  // Run one IIR filter over a block field, keeping the filter state in registers
+  static void HOT_PATH lowPassBlock(IIRFilter& f, MagneticData* block, size_t count,
+                           float MagneticData::*in, float MagneticData::*out) {
+    const float a = f.alpha;
+    const float b = 1.0f - a;
+    float y = f.previousOutput;
+    for (size_t i = 0; i < count; i++) {
+      y = a * (block[i].*in) + b * y;
+      block[i].*out = y;
+    }
+    f.previousOutput = y;
+  }
+  
+  // High-pass as original - low_pass
+  static void HOT_PATH highPassBlock(MagneticData* block, size_t count,
+                            float MagneticData::*in, float MagneticData::*low, float MagneticData::*out) {
+    for (size_t i = 0; i < count; i++) {
+      block[i].*out = block[i].*in - block[i].*low;
+    }
+  }
+  
+  // Graph-gated stages: compiled out entirely when nothing downstream consumes `node`
+  template <SignalNode node>
+  static inline void lowPassStage(IIRFilter& f, MagneticData* block, size_t count,
+                                  float MagneticData::*in, float MagneticData::*out) {
+    if constexpr (SignalGraph::isLive(node)) lowPassBlock(f, block, count, in, out);
+  }
+  
+  template <SignalNode node>
+  static inline void highPassStage(MagneticData* block, size_t count,
+                                   float MagneticData::*in, float MagneticData::*low, float MagneticData::*out) {
+    if constexpr (SignalGraph::isLive(node)) highPassBlock(block, count, in, low, out);
   }
   
   void applyMainFilterMagneticSensor(MagneticData& data) {
-    data.x = filterX.filter(data.x);
-    data.y = filterY.filter(data.y);
-    data.z = filterZ.filter(data.z);
-    data.magnitude = filterMagnitude.filter(data.magnitude);
+    applyMainFilterBlock(&data, 1);
   }
   
   void applyBandSplitFilterMagneticSensor(MagneticData& data) {
+    applyBandSplitFilterBlock(&data, 1);
+  }
+  
+  void HOT_PATH applyMainFilterBlock(MagneticData* block, size_t count) {
+    lowPassStage<NODE_MAIN_LP_X>(filterX, block, count, &MagneticData::x, &MagneticData::x);
+    lowPassStage<NODE_MAIN_LP_Y>(filterY, block, count, &MagneticData::y, &MagneticData::y);
+    lowPassStage<NODE_MAIN_LP_Z>(filterZ, block, count, &MagneticData::z, &MagneticData::z);
+    lowPassStage<NODE_MAIN_LP_MAGNITUDE>(filterMagnitude, block, count, &MagneticData::magnitude, &MagneticData::magnitude);
+  }
+  
+  void HOT_PATH applyBandSplitFilterBlock(MagneticData* block, size_t count) {
     // Apply 30 Hz low-pass filter
-    data.x_low_pass = filter30Hz_X.filter(data.x);
-    data.y_low_pass = filter30Hz_Y.filter(data.y);
-    data.z_low_pass = filter30Hz_Z.filter(data.z);
-    data.magnitude_low_pass = filter30Hz_Magnitude.filter(data.magnitude);
+    lowPassStage<NODE_LOW_PASS_X>(filter30Hz_X, block, count, &MagneticData::x, &MagneticData::x_low_pass);
+    lowPassStage<NODE_LOW_PASS_Y>(filter30Hz_Y, block, count, &MagneticData::y, &MagneticData::y_low_pass);
+    lowPassStage<NODE_LOW_PASS_Z>(filter30Hz_Z, block, count, &MagneticData::z, &MagneticData::z_low_pass);
+    lowPassStage<NODE_LOW_PASS_MAGNITUDE>(filter30Hz_Magnitude, block, count, &MagneticData::magnitude, &MagneticData::magnitude_low_pass);
     
-    // Calculate high-pass as original - low_pass
-    data.x_high_pass = data.x - data.x_low_pass;
-    data.y_high_pass = data.y - data.y_low_pass;
-    data.z_high_pass = data.z - data.z_low_pass;
-    data.magnitude_high_pass = data.magnitude - data.magnitude_low_pass;
+    highPassStage<NODE_HIGH_PASS_X>(block, count, &MagneticData::x, &MagneticData::x_low_pass, &MagneticData::x_high_pass);
+    highPassStage<NODE_HIGH_PASS_Y>(block, count, &MagneticData::y, &MagneticData::y_low_pass, &MagneticData::y_high_pass);
+    highPassStage<NODE_HIGH_PASS_Z>(block, count, &MagneticData::z, &MagneticData::z_low_pass, &MagneticData::z_high_pass);
+    highPassStage<NODE_HIGH_PASS_MAGNITUDE>(block, count, &MagneticData::magnitude, &MagneticData::magnitude_low_pass, &MagneticData::magnitude_high_pass);
   }
   
-  float filterCurrent(float raw_current_mA) {
-    return (float)filterCurrentMA.filter((double)raw_current_mA);
+  float HOT_PATH filterCurrent(float raw_current_mA) {
+    return filterCurrentMA.filter(raw_current_mA);
   }
   
   void reset() {
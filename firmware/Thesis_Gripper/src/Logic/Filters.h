@@ -21,6 +21,10 @@ namespace Filters {
   // Apply 30 Hz low-pass filter and calculate high-pass
   void applyBandSplitFilterMagneticSensor(MagneticData& data);
   
+  // Block variants: same filters over `count` consecutive samples (oldest first)
+  void applyMainFilterBlock(MagneticData* block, size_t count);
+  void applyBandSplitFilterBlock(MagneticData* block, size_t count);
+  
   // Apply filter to current reading
   float filterCurrent(float raw_current_mA);
   
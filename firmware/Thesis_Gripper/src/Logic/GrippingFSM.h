@@ -3,27 +3,26 @@
 
 #include "../Config.h"
 #include "../Types.h"
-#include "../Globals.h"
 
 // ============================================
 // GRIPPING FINITE STATE MACHINE MODULE
 // ============================================
 
 namespace GrippingFSM {
-  // Process the gripping state machine
-  void process(const ButtonState& buttons, float current_mA, float magnitude);
+  // Process the gripping state machine (inputs and outputs live in state)
+  void process(ControlState& state, uint32_t now_ms);
   
   // Get current state
-  GrippingMode getState();
+  GrippingMode getState(const ControlState& state);
   
   // Get motor position
-  int getServoPosition();
+  int getServoPosition(const ControlState& state);
   
   // Reset to initial state
-  void reset();
+  void reset(ControlState& state);
   
   // Get state name as string (for debugging)
-  const char* getStateName();
+  const char* getStateName(const ControlState& state);
 }
 
 #endif // GRIPPING_FSM_H
@@ -0,0 +1,288 @@
+#include "OnlineCalibration.h"
+#include "../Drivers/MagneticSensor.h"
+#include <Preferences.h>
+
+namespace OnlineCalibration {
+
+  struct Matrix {
+    float m[3][3];
+  };
+
+  // Sums of the current window, shifted by its first sample so the squares stay small
+  // (control task only). Mean and variance are formed once, when the window closes.
+  static uint32_t n = 0;
+  static float shift[3] = {0, 0, 0};
+  static float sum[3] = {0, 0, 0};
+  static float sumSq[3] = {0, 0, 0};
+
+  static uint32_t windowsRejected = 0;
+  static float lastRejectedVar = 0.0f;
+  // Quietest rejected window since the last accepted one (fallback without a zero)
+  static uint32_t rejectedInRow = 0;
+  static float bestRejectedVar = INFINITY;
+  static float bestRejectedMean[3] = {0, 0, 0};
+  static uint32_t fallbacks = 0;
+  // Set by the debug task, cleared by the control task once the reset zero is published
+  static std::atomic<bool> recalibrateRequested(false);
+  // Stored zero still to be erased (debug task only)
+  static bool eraseRequested = false;
+  static Seqlock<CalibrationData> published;
+
+  // Matrix handed over from the debug task, applied between samples
+  static Seqlock<Matrix> stagedMatrix;
+  static std::atomic<bool> matrixPending(false);
+  static bool matrixStored = false;
+
+  // Last zero written to NVS (debug task only)
+  static float savedOffset[3] = {0, 0, 0};
+  static bool offsetSaved = false;
+  static uint32_t lastSaveMs = 0;
+
+  // Finite, bounded gains and well away from singular
+  static bool isUsableMatrix(const float m[3][3]) {
+    for (int r = 0; r < 3; r++) {
+      for (int c = 0; c < 3; c++) {
+        if (!isfinite(m[r][c]) || fabsf(m[r][c]) > CALIB_MATRIX_MAX_GAIN) return false;
+      }
+    }
+    float det = m[0][0] * (m[1][1] * m[2][2] - m[1][2] * m[2][1])
+              - m[0][1] * (m[1][0] * m[2][2] - m[1][2] * m[2][0])
+              + m[0][2] * (m[1][0] * m[2][1] - m[1][1] * m[2][0]);
+    return isfinite(det) && fabsf(det) >= CALIB_MATRIX_MIN_DET;
+  }
+
+  static inline void resetWindow() {
+    n = 0;
+    sum[0] = sum[1] = sum[2] = 0.0f;
+    sumSq[0] = sumSq[1] = sumSq[2] = 0.0f;
+  }
+
+  static inline void HOT_PATH accumulate(int axis, float v) {
+    if (n == 1) shift[axis] = v;
+    float d = v - shift[axis];
+    sum[axis] += d;
+    sumSq[axis] += d * d;
+  }
+
+  static void acceptWindow(CalibrationData& cal, const float windowMean[3], float var);
+
+  static void finishWindow(CalibrationData& cal) {
+    const float invN = 1.0f / n;
+    float mean[3];
+    float var = 0.0f;
+    for (int axis = 0; axis < 3; axis++) {
+      mean[axis] = shift[axis] + sum[axis] * invN;
+      float m2 = sumSq[axis] - sum[axis] * sum[axis] * invN;
+      if (m2 > var) var = m2;
+    }
+    var /= (n - 1);
+
+    if (var > CALIB_STILL_VARIANCE_MT2) {
+      // Something moved within the window; do not learn from it
+      windowsRejected++;
+      lastRejectedVar = var;
+      rejectedInRow++;
+      if (var < bestRejectedVar) {
+        bestRejectedVar = var;
+        memcpy(bestRejectedMean, mean, sizeof(bestRejectedMean));
+      }
+      // No zero at all: better a noisy one than a gripper that never grasps
+      if (!cal.valid && rejectedInRow >= CALIB_FALLBACK_WINDOWS) {
+        fallbacks++;
+        acceptWindow(cal, bestRejectedMean, bestRejectedVar);
+      }
+      return;
+    }
+    acceptWindow(cal, mean, var);
+  }
+
+  static void acceptWindow(CalibrationData& cal, const float windowMean[3], float var) {
+    rejectedInRow = 0;
+    bestRejectedVar = INFINITY;
+
+    // First window sets the zero (also over a restored one), later ones track drift smoothly
+    const float gain = (cal.valid && !cal.restored) ? CALIB_DRIFT_GAIN : 1.0f;
+    cal.x_offset += (windowMean[0] - cal.x_offset) * gain;
+    cal.y_offset += (windowMean[1] - cal.y_offset) * gain;
+    cal.z_offset += (windowMean[2] - cal.z_offset) * gain;
+    cal.noise_mT = sqrtf(var);
+    cal.updates++;
+    cal.valid = true;
+    cal.restored = false;
+    published.write(cal);
+  }
+
+  void init(CalibrationData& cal) {
+    Preferences prefs;
+    Matrix stored;
+    if (prefs.begin(CALIB_NVS_NAMESPACE, true)) {
+      matrixStored = prefs.getBytes("matrix", &stored, sizeof(stored)) == sizeof(stored);
+      offsetSaved = prefs.getBytes("offset", savedOffset, sizeof(savedOffset)) == sizeof(savedOffset);
+      prefs.end();
+    }
+    if (matrixStored && !isUsableMatrix(stored.m)) {
+      // Corrupt or from an older bad write: run on identity rather than break every sample
+      Serial.println("[CALIB] Stored matrix rejected, using identity");
+      matrixStored = false;
+    }
+    if (matrixStored) {
+      memcpy(cal.matrix, stored.m, sizeof(cal.matrix));
+    }
+    if (offsetSaved) {
+      // Usable straight away; the first still window replaces it
+      cal.x_offset = savedOffset[0];
+      cal.y_offset = savedOffset[1];
+      cal.z_offset = savedOffset[2];
+      cal.valid = true;
+      cal.restored = true;
+    }
+    published.write(cal);
+    Serial.printf("[CALIB] ✓ Ready (%s matrix, %s zero)\n",
+                  matrixStored ? "stored" : "identity", offsetSaved ? "restored" : "learning");
+  }
+
+  void HOT_PATH update(float x, float y, float z, const ControlState& state, bool still, CalibrationData& cal) {
+    if (recalibrateRequested.load(std::memory_order_acquire)) {
+      resetWindow();
+      // Only the learned zero is discarded; the fitted matrix stays
+      cal.x_offset = cal.y_offset = cal.z_offset = 0.0f;
+      cal.noise_mT = 0.0f;
+      cal.updates = 0;
+      cal.valid = false;
+      cal.restored = false;
+      rejectedInRow = 0;
+      bestRejectedVar = INFINITY;
+      published.write(cal);
+      // Only now may the debug task trust the snapshot again
+      recalibrateRequested.store(false, std::memory_order_release);
+    }
+
+    if (matrixPending.load(std::memory_order_acquire)) {
+      matrixPending.store(false, std::memory_order_relaxed);
+      Matrix staged;
+      stagedMatrix.read(staged);
+      memcpy(cal.matrix, staged.m, sizeof(cal.matrix));
+      published.write(cal);
+    }
+
+    if (state.gripping_mode != GRIPPING_MODE_OPEN || !still) {
+      resetWindow();
+      return;
+    }
+
+    n++;
+    accumulate(0, x);
+    accumulate(1, y);
+    accumulate(2, z);
+
+    if (n >= CALIB_WINDOW_SAMPLES) {
+      finishWindow(cal);
+      resetWindow();
+    }
+  }
+
+  void requestRecalibration() {
+    // The stored zero is erased by servicePersistence() once the control task has
+    // dropped it; erasing here would let the still-published old zero be written back
+    eraseRequested = true;
+    recalibrateRequested.store(true, std::memory_order_release);
+  }
+
+  bool servicePersistence(bool gripperOpen) {
+    // The published snapshot still holds the zero being discarded
+    if (recalibrateRequested.load(std::memory_order_acquire)) return false;
+    if (!gripperOpen) return false;
+
+    bool eraseDone = false;
+    if (eraseRequested) {
+      // Also forget the stored zero, so a reboot does not bring it back
+      Preferences prefs;
+      if (!prefs.begin(CALIB_NVS_NAMESPACE, false)) return false;
+      prefs.remove("offset");
+      prefs.end();
+      offsetSaved = false;
+      eraseRequested = false;
+      eraseDone = true;
+    }
+
+    CalibrationData cal;
+    getSnapshot(cal);
+    if (!cal.valid || cal.restored) return eraseDone;
+
+    // Rate-limited: the zero drifts slowly and every write costs flash wear
+    const float offset[3] = {cal.x_offset, cal.y_offset, cal.z_offset};
+    if (offsetSaved) {
+      if (millis() - lastSaveMs < CALIB_SAVE_INTERVAL_MS) return eraseDone;
+      float change = 0.0f;
+      for (int axis = 0; axis < 3; axis++) {
+        change = fmaxf(change, fabsf(offset[axis] - savedOffset[axis]));
+      }
+      if (change < CALIB_SAVE_DELTA_MT) return eraseDone;
+    }
+
+    Preferences prefs;
+    if (!prefs.begin(CALIB_NVS_NAMESPACE, false)) return eraseDone;
+    if (prefs.putBytes("offset", offset, sizeof(offset)) == sizeof(offset)) {
+      memcpy(savedOffset, offset, sizeof(savedOffset));
+      offsetSaved = true;
+    }
+    prefs.end();
+    lastSaveMs = millis();
+    return true;
+  }
+
+  bool setMatrix(const float m[9], bool persist) {
+    Matrix staged;
+    memcpy(staged.m, m, sizeof(staged.m));
+    if (!isUsableMatrix(staged.m)) return false;
+
+    if (persist) {
+      Preferences prefs;
+      if (!prefs.begin(CALIB_NVS_NAMESPACE, false)) return false;
+      bool ok = prefs.putBytes("matrix", &staged, sizeof(staged)) == sizeof(staged);
+      prefs.end();
+      if (!ok) return false;
+      matrixStored = true;
+    }
+
+    stagedMatrix.write(staged);
+    matrixPending.store(true, std::memory_order_release);
+    return true;
+  }
+
+  // Cycles per applyCalibration call (same code path as the control task)
+  static uint32_t measureCostCycles(const CalibrationData& cal) {
+    volatile float sink = 0.0f;
+    float x = 0.1f, y = 0.2f, z = 0.3f;
+    uint32_t start = ESP.getCycleCount();
+    for (uint32_t i = 0; i < CALIB_COST_BENCH_SAMPLES; i++) {
+      MagneticSensor::applyCalibration(x, y, z, cal);
+      sink = x + y + z;
+    }
+    uint32_t cycles = ESP.getCycleCount() - start;
+    (void)sink;
+    return cycles / CALIB_COST_BENCH_SAMPLES;
+  }
+
+  void getSnapshot(CalibrationData& out) {
+    published.read(out);
+  }
+
+  void printReport(Print& out) {
+    CalibrationData cal;
+    getSnapshot(cal);
+    const float (&m)[3][3] = cal.matrix;
+    out.printf("{\"type\":\"calib\",\"valid\":%d,\"updates\":%lu,\"rejected\":%lu,\"rejected_var\":%.4f,"
+               "\"limit_var\":%.4f,\"fallback\":%lu,"
+               "\"offset\":[%.4f,%.4f,%.4f],\"noise\":%.4f,\"window\":%lu,"
+               "\"matrix\":[%.5f,%.5f,%.5f,%.5f,%.5f,%.5f,%.5f,%.5f,%.5f],\"stored\":%d,"
+               "\"restored\":%d,\"zero_saved\":%d,\"cost_cycles\":%lu}",
+               cal.valid ? 1 : 0, (unsigned long)cal.updates, (unsigned long)windowsRejected, lastRejectedVar,
+               CALIB_STILL_VARIANCE_MT2, (unsigned long)fallbacks,
+               cal.x_offset, cal.y_offset, cal.z_offset, cal.noise_mT,
+               (unsigned long)CALIB_WINDOW_SAMPLES,
+               m[0][0], m[0][1], m[0][2], m[1][0], m[1][1], m[1][2], m[2][0], m[2][1], m[2][2],
+               matrixStored ? 1 : 0, cal.restored ? 1 : 0, offsetSaved ? 1 : 0,
+               (unsigned long)measureCostCycles(cal));
+  }
+}
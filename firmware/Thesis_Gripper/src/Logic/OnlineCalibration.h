@@ -0,0 +1,46 @@
+#ifndef ONLINE_CALIBRATION_H
+#define ONLINE_CALIBRATION_H
+
+#include <Arduino.h>
+#include "../Config.h"
+#include "../Types.h"
+
+// ============================================
+// STREAMING MAGNETIC ZERO CALIBRATION
+// Accumulates raw samples (shifted sums; mean/variance formed at window
+// close) while the gripper is OPEN and still. A window that stays quiet
+// for CALIB_WINDOW_SAMPLES becomes the new zero; it is blended into
+// `calData` between samples of the control task, so no reader ever sees
+// half an update.
+// The 3x3 cross-axis matrix is fitted on host and only stored here.
+// Matrix and zero are kept in NVS; a stored zero lets the gripper grasp
+// right after boot and is replaced by the first still window.
+// ============================================
+
+namespace OnlineCalibration {
+  // Load the stored correction matrix and zero into `cal` (setup, before the timer starts)
+  void init(CalibrationData& cal);
+
+  // Control task, once per new raw sample (before applyCalibration)
+  void update(float x, float y, float z, const ControlState& state, bool still, CalibrationData& cal);
+
+  // Discard the current window and the zero (forces a fresh first window); keeps the matrix
+  void requestRecalibration();
+
+  // Stage a row-major correction matrix, adopted by the control task on its next sample.
+  // persist writes it to NVS (call from the debug task, never from the control task).
+  // Rejects non-finite entries, |entries| > CALIB_MATRIX_MAX_GAIN and |det| < CALIB_MATRIX_MIN_DET.
+  bool setMatrix(const float m[9], bool persist);
+
+  // Debug task: write the zero to NVS when it has moved (rate-limited, only while the
+  // gripper is OPEN since a flash write stalls the scan cycle); true if NVS was written
+  bool servicePersistence(bool gripperOpen);
+
+  // Latest published copy of the calibration for other tasks
+  void getSnapshot(CalibrationData& out);
+
+  // Print calibration state as one JSON object
+  void printReport(Print& out);
+}
+
+#endif // ONLINE_CALIBRATION_H
@@ -0,0 +1,59 @@
+#include "SampleRing.h"
+#include <atomic>
+
+namespace SampleRing {
+
+  static SampleRecord buffer[SAMPLE_RING_CAPACITY];
+
+  // head is written only by the producer, tail only by the consumer
+  static std::atomic<uint32_t> head(0);
+  static std::atomic<uint32_t> tail(0);
+  static std::atomic<uint32_t> overflows(0);
+  static std::atomic<bool> enabled(false);
+
+  void setEnabled(bool enable) {
+    if (enable && !enabled.load()) {
+      // Start each capture with an empty ring and a clean overflow count
+      tail.store(head.load(std::memory_order_acquire), std::memory_order_release);
+      overflows.store(0);
+    }
+    enabled.store(enable);
+  }
+
+  bool isEnabled() {
+    return enabled.load(std::memory_order_relaxed);
+  }
+
+  bool HOT_PATH push(const SampleRecord& record) {
+    if (!enabled.load(std::memory_order_relaxed)) return false;
+
+    uint32_t h = head.load(std::memory_order_relaxed);
+    uint32_t t = tail.load(std::memory_order_acquire);
+    if (h - t >= SAMPLE_RING_CAPACITY) {
+      overflows.fetch_add(1, std::memory_order_relaxed);
+      return false;
+    }
+
+    buffer[h & (SAMPLE_RING_CAPACITY - 1)] = record;
+    head.store(h + 1, std::memory_order_release);
+    return true;
+  }
+
+  size_t drain(SampleRecord* out, size_t maxCount) {
+    uint32_t t = tail.load(std::memory_order_relaxed);
+    uint32_t h = head.load(std::memory_order_acquire);
+
+    size_t count = 0;
+    while (t != h && count < maxCount) {
+      out[count++] = buffer[t & (SAMPLE_RING_CAPACITY - 1)];
+      t++;
+    }
+
+    tail.store(t, std::memory_order_release);
+    return count;
+  }
+
+  uint32_t overflowCount() {
+    return overflows.load(std::memory_order_relaxed);
+  }
+}
@@ -0,0 +1,28 @@
+#ifndef SAMPLE_RING_H
+#define SAMPLE_RING_H
+
+#include <Arduino.h>
+#include "../Config.h"
+#include "../Types.h"
+
+// ============================================
+// LOCK-FREE SPSC SAMPLE RING
+// Producer: control task (Core 1), consumer: debug task (Core 0)
+// ============================================
+
+namespace SampleRing {
+  // Start/stop accepting records (push is a no-op while disabled)
+  void setEnabled(bool enabled);
+  bool isEnabled();
+
+  // Producer side: append one record, counts an overflow if the ring is full
+  bool push(const SampleRecord& record);
+
+  // Consumer side: move up to maxCount records into out, returns number copied
+  size_t drain(SampleRecord* out, size_t maxCount);
+
+  // Records dropped because the consumer fell behind
+  uint32_t overflowCount();
+}
+
+#endif // SAMPLE_RING_H
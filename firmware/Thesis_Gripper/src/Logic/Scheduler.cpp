@@ -0,0 +1,127 @@
+#include "Scheduler.h"
+#include <Arduino.h>
+
+namespace Scheduler {
+
+  static RateGroup* groups = nullptr;
+  static size_t groupCount = 0;
+  static volatile bool resetRequested = false;
+
+  // Position inside the hyperperiod (LCM of all dividers). Advancing it by the tick
+  // delta keeps every phase aligned across missed ticks and tick-counter wrap.
+  static uint32_t hyperperiod = 1;
+  static uint32_t slot = 0;
+  static uint32_t lastTick = 0;
+  static bool started = false;
+
+  static uint32_t gcd(uint32_t a, uint32_t b) {
+    while (b != 0) {
+      uint32_t t = a % b;
+      a = b;
+      b = t;
+    }
+    return a;
+  }
+
+  static void clearStats() {
+    for (size_t i = 0; i < groupCount; i++) {
+      groups[i].runs = 0;
+      groups[i].late = 0;
+      groups[i].last_us = 0;
+      groups[i].max_us = 0;
+      groups[i].total_us = 0;
+    }
+  }
+
+  void init(RateGroup* table, size_t count) {
+    groups = table;
+    groupCount = count;
+
+    for (size_t i = 0; i < groupCount; i++) {
+      if (groups[i].divider == 0) groups[i].divider = 1;
+      if (groups[i].phase >= groups[i].divider) {
+        Serial.printf("[SCHED] Warning: %s phase %lu >= divider %lu, wrapped\n",
+                      groups[i].name, (unsigned long)groups[i].phase, (unsigned long)groups[i].divider);
+        groups[i].phase %= groups[i].divider;
+      }
+    }
+    clearStats();
+
+    uint64_t lcm = 1;
+    for (size_t i = 0; i < groupCount; i++) {
+      lcm = lcm / gcd((uint32_t)lcm, groups[i].divider) * groups[i].divider;
+      if (lcm > UINT32_MAX / 2) {
+        Serial.println("[SCHED] Warning: dividers have no common period below 2^31");
+        lcm = 1;
+        break;
+      }
+    }
+    hyperperiod = (uint32_t)lcm;
+    started = false;
+
+    // Two slow tasks share a tick iff their phases are congruent modulo gcd(dividers)
+    for (size_t i = 0; i < groupCount; i++) {
+      for (size_t j = i + 1; j < groupCount; j++) {
+        if (groups[i].divider == 1 || groups[j].divider == 1) continue;
+        uint32_t g = gcd(groups[i].divider, groups[j].divider);
+        if ((groups[i].phase % g) == (groups[j].phase % g)) {
+          Serial.printf("[SCHED] Warning: %s and %s share ticks\n", groups[i].name, groups[j].name);
+        }
+      }
+    }
+
+    Serial.printf("[SCHED] ✓ %u tasks scheduled (period %lu ticks)\n", (unsigned)groupCount, (unsigned long)hyperperiod);
+  }
+
+  void HOT_PATH run(uint32_t tick) {
+    if (resetRequested) {
+      clearStats();
+      resetRequested = false;
+    }
+
+    // Ticks since the last cycle (unsigned difference survives counter wrap)
+    uint32_t ticks = 1;
+    if (!started) {
+      slot = tick % hyperperiod;
+      started = true;
+    } else {
+      ticks = tick - lastTick;
+      if (ticks == 0) return;
+      slot = (uint32_t)(((uint64_t)slot + ticks) % hyperperiod);
+    }
+    lastTick = tick;
+
+    for (size_t i = 0; i < groupCount; i++) {
+      RateGroup& g = groups[i];
+      // Ticks since this task's most recent slot; due if that slot was not seen yet
+      uint32_t sinceSlot = (slot + g.divider - g.phase) % g.divider;
+      if (sinceSlot >= ticks) continue;
+      if (sinceSlot > 0) g.late++;
+
+      unsigned long start = micros();
+      g.task();
+      uint32_t elapsed = micros() - start;
+
+      g.runs++;
+      g.last_us = elapsed;
+      g.total_us += elapsed;
+      if (elapsed > g.max_us) g.max_us = elapsed;
+    }
+  }
+
+  void resetStats() {
+    resetRequested = true;
+  }
+
+  void printReport(Print& out) {
+    out.printf("{\"type\":\"sched\",\"budget_us\":%lu,\"tasks\":[", (unsigned long)SCAN_INTERVAL_US);
+    for (size_t i = 0; i < groupCount; i++) {
+      const RateGroup& g = groups[i];
+      uint32_t avg = g.runs > 0 ? (uint32_t)(g.total_us / g.runs) : 0;
+      out.printf("%s{\"name\":\"%s\",\"div\":%lu,\"phase\":%lu,\"runs\":%lu,\"late\":%lu,\"last\":%lu,\"avg\":%lu,\"max\":%lu}",
+                 i == 0 ? "" : ",", g.name, (unsigned long)g.divider, (unsigned long)g.phase,
+                 (unsigned long)g.runs, (unsigned long)g.late, (unsigned long)g.last_us, (unsigned long)avg, (unsigned long)g.max_us);
+    }
+    out.print("]}");
+  }
+}
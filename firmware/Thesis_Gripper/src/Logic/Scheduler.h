@@ -0,0 +1,44 @@
+#ifndef SCHEDULER_H
+#define SCHEDULER_H
+
+#include <Arduino.h>
+#include "../Config.h"
+
+// ============================================
+// MULTI-RATE SCAN CYCLE SCHEDULER
+// ============================================
+
+namespace Scheduler {
+  typedef void (*TaskFunction)();
+
+  // One table entry. A task runs on every timer tick where (tick % divider) == phase,
+  // so tasks with equal dividers but different phases never share a tick. Phases are
+  // keyed on the ISR tick count, so a missed tick does not shift them.
+  struct RateGroup {
+    const char* name;
+    uint32_t divider;  // Timer ticks per run (1 = every tick)
+    uint32_t phase;    // Tick offset inside the period, 0..divider-1
+    TaskFunction task;
+
+    // Execution statistics (written by the control task)
+    uint32_t runs;
+    uint32_t late;     // Runs made up after their slot fell on a missed tick
+    uint32_t last_us;
+    uint32_t max_us;
+    uint64_t total_us;
+  };
+
+  // Register the table (entries run in table order) and warn about phase collisions
+  void init(RateGroup* table, size_t count);
+
+  // Run every task whose slot lies in the ticks since the last call (ISR tick count)
+  void run(uint32_t tick);
+
+  // Clear execution statistics (safe to call from another core)
+  void resetStats();
+
+  // Print per-task execution times as one JSON object
+  void printReport(Print& out);
+}
+
+#endif // SCHEDULER_H
@@ -0,0 +1,23 @@
+#include "SignalGraph.h"
+
+namespace SignalGraph {
+
+  static const char* const NODE_NAMES[NODE_COUNT] = {
+    "mag_source", "magnitude",
+    "main_lp_x", "main_lp_y", "main_lp_z", "main_lp_mag",
+    "low_pass_x", "low_pass_y", "low_pass_z", "low_pass_mag",
+    "high_pass_x", "high_pass_y", "high_pass_z", "high_pass_mag",
+    "slip_spectrum", "stream_spectrum", "slip_detector", "grip_fsm", "telemetry",
+  };
+
+  void printSchedule() {
+    Serial.printf("[GRAPH] %u of %u stages live:", (unsigned)liveNodeCount(), (unsigned)NODE_COUNT);
+    for (int n = 0; n < NODE_COUNT; n++) {
+      if (isLive((SignalNode)n)) {
+        Serial.print(" ");
+        Serial.print(NODE_NAMES[n]);
+      }
+    }
+    Serial.println();
+  }
+}
@@ -0,0 +1,107 @@
+#ifndef SIGNAL_GRAPH_H
+#define SIGNAL_GRAPH_H
+
+#include <Arduino.h>
+#include "../Config.h"
+
+// ============================================
+// COMPILE-TIME SIGNAL FLOW GRAPH
+// Edges describe which stage feeds which. isLive() is evaluated by the
+// compiler, so `if constexpr (isLive(node))` around each stage leaves a
+// straight-line per-cycle schedule containing only consumed stages.
+// ============================================
+
+namespace SignalGraph {
+  struct Edge {
+    SignalNode from;
+    SignalNode to;
+  };
+
+  // Graph node an FFT channel source reads from
+  constexpr SignalNode sourceNode(FFTChannelSource source) {
+    return source == FFT_SOURCE_X_HIGH_PASS ? NODE_HIGH_PASS_X :
+           source == FFT_SOURCE_Y_HIGH_PASS ? NODE_HIGH_PASS_Y :
+           source == FFT_SOURCE_Z_HIGH_PASS ? NODE_HIGH_PASS_Z :
+           source == FFT_SOURCE_MAGNITUDE_HIGH_PASS ? NODE_HIGH_PASS_MAGNITUDE :
+           source == FFT_SOURCE_X_LOW_PASS ? NODE_LOW_PASS_X :
+           source == FFT_SOURCE_Y_LOW_PASS ? NODE_LOW_PASS_Y :
+           source == FFT_SOURCE_Z_LOW_PASS ? NODE_LOW_PASS_Z :
+           NODE_LOW_PASS_MAGNITUDE;
+  }
+
+  constexpr Edge EDGES[] = {
+    {NODE_MAG_SOURCE, NODE_MAGNITUDE},
+    {NODE_MAG_SOURCE, NODE_MAIN_LP_X},
+    {NODE_MAG_SOURCE, NODE_MAIN_LP_Y},
+    {NODE_MAG_SOURCE, NODE_MAIN_LP_Z},
+    {NODE_MAGNITUDE, NODE_MAIN_LP_MAGNITUDE},
+
+    {NODE_MAIN_LP_X, NODE_LOW_PASS_X},
+    {NODE_MAIN_LP_Y, NODE_LOW_PASS_Y},
+    {NODE_MAIN_LP_Z, NODE_LOW_PASS_Z},
+    {NODE_MAIN_LP_MAGNITUDE, NODE_LOW_PASS_MAGNITUDE},
+
+    {NODE_MAIN_LP_X, NODE_HIGH_PASS_X},
+    {NODE_LOW_PASS_X, NODE_HIGH_PASS_X},
+    {NODE_MAIN_LP_Y, NODE_HIGH_PASS_Y},
+    {NODE_LOW_PASS_Y, NODE_HIGH_PASS_Y},
+    {NODE_MAIN_LP_Z, NODE_HIGH_PASS_Z},
+    {NODE_LOW_PASS_Z, NODE_HIGH_PASS_Z},
+    {NODE_MAIN_LP_MAGNITUDE, NODE_HIGH_PASS_MAGNITUDE},
+    {NODE_LOW_PASS_MAGNITUDE, NODE_HIGH_PASS_MAGNITUDE},
+
+    {sourceNode(SLIP_DETECTION_SOURCE), NODE_SLIP_SPECTRUM},
+    {sourceNode(FFT_STREAM_SOURCE), NODE_STREAM_SPECTRUM},
+    {NODE_SLIP_SPECTRUM, NODE_SLIP_DETECTOR},
+    {NODE_SLIP_DETECTOR, NODE_GRIP_FSM},
+    {NODE_MAIN_LP_MAGNITUDE, NODE_GRIP_FSM},
+  };
+
+  constexpr bool isTelemetrySignal(SignalNode node) {
+    for (SignalNode s : TELEMETRY_SIGNALS) {
+      if (s == node) return true;
+    }
+    return false;
+  }
+
+  // A node is live if it is a sink, is shown by telemetry, or feeds a live node
+  constexpr bool isLive(SignalNode node) {
+    if (node == NODE_GRIP_FSM || node == NODE_TELEMETRY || isTelemetrySignal(node)) return true;
+    for (const Edge& e : EDGES) {
+      if (e.from == node && isLive(e.to)) return true;
+    }
+    return false;
+  }
+
+  // An FFT channel is fed only if one of its spectra has a consumer
+  constexpr bool isChannelLive(int channel) {
+    return (channel == SLIP_FFT_CHANNEL && isLive(NODE_SLIP_SPECTRUM)) ||
+           (channel == STREAM_FFT_CHANNEL && isLive(NODE_STREAM_SPECTRUM));
+  }
+
+  // Indices of the live FFT channels, resolved at compile time so the per-block
+  // loops visit only these instead of testing every channel at run time
+  struct ChannelList {
+    uint8_t index[FFT_CHANNEL_COUNT];
+    size_t count;
+  };
+
+  constexpr ChannelList liveChannels() {
+    ChannelList list = {};
+    for (size_t c = 0; c < FFT_CHANNEL_COUNT; c++) {
+      if (isChannelLive((int)c)) list.index[list.count++] = (uint8_t)c;
+    }
+    return list;
+  }
+
+  constexpr ChannelList LIVE_CHANNELS = liveChannels();
+
+  constexpr size_t liveNodeCount(int node = 0) {
+    return node >= NODE_COUNT ? 0 : (isLive((SignalNode)node) ? 1 : 0) + liveNodeCount(node + 1);
+  }
+
+  // Print which stages the schedule contains
+  void printSchedule();
+}
+
+#endif // SIGNAL_GRAPH_H
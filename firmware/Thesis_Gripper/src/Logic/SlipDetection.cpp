@@ -1,75 +1,67 @@
 #include "SlipDetection.h"
+#include "FFTChannels.h"
 #include <Arduino.h>
 
 namespace SlipDetection {
   
   static int ignore_counter = 0;
 
-  void detect() {
+  void HOT_PATH detect(ControlState& state) {
     // Handle ignore counter (vibration filtering)
     
 
+    AxisFFT& slipFFT = FFTChannels::get(SLIP_FFT_CHANNEL);
+
     // Check if FFT data is ready
-    if (fftY_high_pass.FFT_complete) {
-      
-      // Calculate frequency bins
-      const uint16_t start_bin = round((float)SLIP_FREQ_START_HZ * FFT_SAMPLES / MAGNETIC_SENSOR_SAMPLING_FREQUENCY);
-      const uint16_t end_bin = round((float)SLIP_FREQ_END_HZ * FFT_SAMPLES / MAGNETIC_SENSOR_SAMPLING_FREQUENCY);
+    if (slipFFT.FFT_complete) {
       
       float max_power = 0;
       int peak_freq = 0;
       
       // Find peak in frequency range
-      for (int i = start_bin; i < end_bin; i++) {
-        float power = (fftY_high_pass.vReal[i] * fftY_high_pass.vReal[i] + 
-                       fftY_high_pass.vImag[i] * fftY_high_pass.vImag[i]) / FFT_SAMPLES;
+      for (int i = SLIP_START_BIN; i < SLIP_END_BIN; i++) {
+        float power = (slipFFT.vReal[i] * slipFFT.vReal[i] + 
+                       slipFFT.vImag[i] * slipFFT.vImag[i]) / FFT_SAMPLES;
         if (power > max_power) {
           max_power = power;
-          peak_freq = i * (MAGNETIC_SENSOR_SAMPLING_FREQUENCY / FFT_SAMPLES);
+          peak_freq = i * FFT_BIN_HZ;
         }
       }
       
       // Calculate slip indicator
-      slip_indicator = max_power * peak_freq;
+      state.slip_indicator = max_power * peak_freq;
       
       // Determine slip flag
-      if (slip_indicator > SLIP_THRESHOLD) {
-        slip_flag = true;
+      if (state.slip_indicator > SLIP_THRESHOLD) {
+        state.slip_flag = true;
       } else {
-        slip_flag = false;
+        state.slip_flag = false;
       }
       
       // Signal that new data is ready
-      new_slip_data_ready = true;
-
-      // Update shared debug data
-      if (mutexSlipData != NULL && xSemaphoreTake(mutexSlipData, pdMS_TO_TICKS(5)) == pdTRUE) {
-        debugData.slip_flag = slip_flag;
-        debugData.slip_indicator = slip_indicator;
-        xSemaphoreGive(mutexSlipData);
-      }
+      state.new_slip_data_ready = true;
       
       // Reset FFT for next cycle
-      fftY_high_pass.FFT_complete = false;
+      slipFFT.FFT_complete = false;
     }
   }
   
-  bool isSlipDetected() {
-    return slip_flag;
+  bool isSlipDetected(const ControlState& state) {
+    return state.slip_flag;
   }
   
-  float getSlipIndicator() {
-    return slip_indicator;
+  float getSlipIndicator(const ControlState& state) {
+    return state.slip_indicator;
   }
   
-  void reset() {
-    slip_flag = false;
-   // slip_indicator = 0.0f;
-    new_slip_data_ready = false;
+  void reset(ControlState& state) {
+    state.slip_flag = false;
+   // state.slip_indicator = 0.0f;
+    state.new_slip_data_ready = false;
   }
 
-  void ignoreFor(int cycles) {
+  void ignoreFor(ControlState& state, int cycles) {
     ignore_counter = cycles;
-    reset();
+    reset(state);
   }
 }
@@ -11,20 +11,20 @@
 
 namespace SlipDetection {
   // Detect slip from FFT data
-  // Updates global slip_flag and slip_indicator
-  void detect();
+  // Updates state.slip_flag and state.slip_indicator
+  void detect(ControlState& state);
   
   // Get current slip status
-  bool isSlipDetected();
+  bool isSlipDetected(const ControlState& state);
   
   // Get slip intensity
-  float getSlipIndicator();
+  float getSlipIndicator(const ControlState& state);
   
   // Reset slip detection state
-  void reset();
+  void reset(ControlState& state);
 
   // Ignore slip detection for a number of scan cycles
-  void ignoreFor(int cycles);
+  void ignoreFor(ControlState& state, int cycles);
 }
 
 #endif // SLIP_DETECTION_H
@@ -0,0 +1,180 @@
+#include "TimingMonitor.h"
+#include "../Globals.h"
+#include <Arduino.h>
+
+namespace TimingMonitor {
+
+  // Written by the timer ISR; read together under tickLock so a tick between
+  // the reads cannot pair one tick's count with another tick's timestamp
+  static portMUX_TYPE tickLock = portMUX_INITIALIZER_UNLOCKED;
+  static volatile uint32_t isrTickCount = 0;
+  static volatile unsigned long isrTimestamp = 0;
+  static volatile unsigned long isrPrevTimestamp = 0;
+
+  // Written by the control loop only
+  static Stats stats;
+  static uint32_t lastSeenTick = 0;
+  static unsigned long cycleStartTime = 0;
+  static uint32_t wakeLatency = 0;
+  static uint32_t execTime = 0;
+  static bool overran = false;
+  static uint32_t windowEvents = 0;
+
+  // Flash (NVS) writes and their cost to the scan cycle (debug task only)
+  static uint32_t flashWrites = 0;
+  static uint32_t flashMaxUs = 0;
+  static uint32_t flashLost = 0;
+  static uint32_t flashMaxLost = 0;
+
+  // Set from the debug task, consumed by the control loop
+  static volatile bool resetRequested = false;
+
+  static void HOT_PATH record(Histogram& h, uint32_t value_us) {
+    uint32_t bin = value_us / TIMING_HIST_BIN_US;
+    if (bin < TIMING_HIST_BINS) {
+      h.bins[bin]++;
+    } else {
+      h.overflow++;
+    }
+    if (value_us > h.max_us) h.max_us = value_us;
+  }
+
+  static void clear() {
+    memset(&stats, 0, sizeof(stats));
+    lastSeenTick = isrTickCount;
+    windowEvents = 0;
+  }
+
+  void init() {
+    clear();
+    Serial.println("[TIMING] ✓ Monitor ready");
+  }
+
+  void reset() {
+    resetRequested = true;
+  }
+
+  void ARDUINO_ISR_ATTR onTimerISR() {
+    portENTER_CRITICAL_ISR(&tickLock);
+    isrPrevTimestamp = isrTimestamp;
+    isrTimestamp = micros();
+    isrTickCount++;
+    portEXIT_CRITICAL_ISR(&tickLock);
+  }
+
+  void HOT_PATH onCycleStart() {
+    cycleStartTime = micros();
+
+    if (resetRequested) {
+      clear();
+      resetRequested = false;
+    }
+
+    portENTER_CRITICAL(&tickLock);
+    uint32_t tick = isrTickCount;
+    unsigned long tickTime = isrTimestamp;
+    unsigned long prevTickTime = isrPrevTimestamp;
+    portEXIT_CRITICAL(&tickLock);
+
+    // More than one tick since the last cycle means wake-ups were coalesced (cycles lost)
+    uint32_t newTicks = tick - lastSeenTick;
+    lastSeenTick = tick;
+    stats.ticks += newTicks;
+    if (newTicks > 1) {
+      stats.missed_ticks += newTicks - 1;
+      windowEvents += newTicks - 1;
+    }
+
+    wakeLatency = cycleStartTime - tickTime;
+    record(stats.wake_latency, wakeLatency);
+
+    if (prevTickTime != 0) {
+      long period = (long)(tickTime - prevTickTime);
+      record(stats.period_jitter, (uint32_t)abs(period - (long)SCAN_INTERVAL_US));
+    }
+  }
+
+  void HOT_PATH onCycleEnd() {
+    execTime = micros() - cycleStartTime;
+    record(stats.exec_time, execTime);
+
+    overran = execTime > SCAN_INTERVAL_US;
+    if (overran) {
+      stats.overruns++;
+      windowEvents++;
+    }
+    stats.cycles++;
+  }
+
+  void evaluateWindow() {
+    stats.window_events = windowEvents;
+    if (windowEvents > TIMING_OVERRUN_FAULT_LIMIT) {
+      stats.fault = true;
+    }
+    windowEvents = 0;
+  }
+
+  uint32_t lostCycles() {
+    return stats.missed_ticks + stats.overruns;
+  }
+
+  void recordFlashWrite(uint32_t duration_us, uint32_t lost) {
+    flashWrites++;
+    flashLost += lost;
+    if (duration_us > flashMaxUs) flashMaxUs = duration_us;
+    if (lost > flashMaxLost) flashMaxLost = lost;
+  }
+
+  uint32_t lastTick() {
+    return lastSeenTick;
+  }
+
+  uint32_t lastWakeLatencyUs() {
+    return wakeLatency;
+  }
+
+  uint32_t lastExecTimeUs() {
+    return execTime;
+  }
+
+  bool lastCycleOverran() {
+    return overran;
+  }
+
+  bool isFaulted() {
+    return stats.fault;
+  }
+
+  void getStats(Stats& out) {
+    out = stats;
+  }
+
+  static void printHistogram(Print& out, const char* name, const Histogram& h) {
+    out.printf("\"%s\":{\"max\":%lu,\"over\":%lu,\"bins\":[", name, (unsigned long)h.max_us, (unsigned long)h.overflow);
+    for (int i = 0; i < TIMING_HIST_BINS; i++) {
+      out.printf(i == 0 ? "%lu" : ",%lu", (unsigned long)h.bins[i]);
+    }
+    out.print("]}");
+  }
+
+  void printReport(Print& out) {
+    Stats local;
+    getStats(local);
+
+    out.printf("{\"type\":\"timing\",\"period_us\":%lu,\"bin_us\":%u,\"iram\":%d,\"dsp_block\":%u,\"dsp_latency_us\":%lu,"
+               "\"ticks\":%lu,\"cycles\":%lu,\"missed\":%lu,\"overruns\":%lu,\"win_events\":%lu,\"fault\":%d,",
+               (unsigned long)SCAN_INTERVAL_US, (unsigned)TIMING_HIST_BIN_US, HOT_PATH_IN_IRAM,
+               (unsigned)DSP_BLOCK_SIZE, (unsigned long)DSP_BLOCK_LATENCY_US,
+               (unsigned long)local.ticks, (unsigned long)local.cycles,
+               (unsigned long)local.missed_ticks, (unsigned long)local.overruns,
+               (unsigned long)local.window_events, local.fault ? 1 : 0);
+    printHistogram(out, "jitter", local.period_jitter);
+    out.print(",");
+    printHistogram(out, "latency", local.wake_latency);
+    out.print(",");
+    printHistogram(out, "exec", local.exec_time);
+    out.printf(",\"flash\":{\"writes\":%lu,\"max_us\":%lu,\"lost\":%lu,\"max_lost\":%lu}}",
+               (unsigned long)flashWrites, (unsigned long)flashMaxUs,
+               (unsigned long)flashLost, (unsigned long)flashMaxLost);
+  }
+}
@@ -0,0 +1,68 @@
+#ifndef TIMING_MONITOR_H
+#define TIMING_MONITOR_H
+
+#include <Arduino.h>
+#include "../Config.h"
+#include "../Types.h"
+
+// ============================================
+// SCAN CYCLE TIMING MONITOR
+// ============================================
+
+namespace TimingMonitor {
+  struct Histogram {
+    uint32_t bins[TIMING_HIST_BINS]; // bin i covers [i, i+1) * TIMING_HIST_BIN_US
+    uint32_t overflow;               // samples beyond the last bin
+    uint32_t max_us;
+  };
+
+  struct Stats {
+    uint32_t ticks;         // Timer ISR firings
+    uint32_t cycles;        // Scan cycles actually executed
+    uint32_t missed_ticks;  // Ticks coalesced into an earlier wake-up (lost cycles)
+    uint32_t overruns;      // Cycles that took longer than SCAN_INTERVAL_US
+    uint32_t window_events; // Missed + overrun events in the last health check window
+    bool fault;             // Latched when window_events > TIMING_OVERRUN_FAULT_LIMIT
+
+    Histogram period_jitter; // |ISR period - SCAN_INTERVAL_US|
+    Histogram wake_latency;  // ISR timestamp -> cycle start
+    Histogram exec_time;     // Cycle start -> cycle end
+  };
+
+  // Reset counters, histograms and the fault flag
+  void init();
+  void reset();
+
+  // Timestamp a timer tick (call from the timer ISR)
+  void onTimerISR();
+
+  // Mark start/end of a scan cycle (call from the control loop)
+  void onCycleStart();
+  void onCycleEnd();
+
+  // Close the current fault window and latch the fault flag if over limit (1 Hz)
+  void evaluateWindow();
+
+  // ISR tick count captured by the last onCycleStart() (scheduler time base)
+  uint32_t lastTick();
+
+  // Latest per-cycle values (for the system telemetry stream)
+  uint32_t lastWakeLatencyUs();
+  uint32_t lastExecTimeUs();
+  bool lastCycleOverran();
+  bool isFaulted();
+
+  // Missed ticks + overruns so far (read from another core, for before/after deltas)
+  uint32_t lostCycles();
+
+  // Record one NVS write and the cycles the scan lost while it ran (debug task)
+  void recordFlashWrite(uint32_t duration_us, uint32_t lost);
+
+  // Copy current statistics (safe to call from another core, may be slightly torn)
+  void getStats(Stats& out);
+
+  // Print statistics and histograms as one JSON object
+  void printReport(Print& out);
+}
+
+#endif // TIMING_MONITOR_H
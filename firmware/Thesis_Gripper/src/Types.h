@@ -2,13 +2,14 @@
 #define TYPES_H
 
 #include <Arduino.h>
+#include <atomic>
 #include "arduinoFFT.h"
 #include "Config.h"
 
 // ============================================
 // GRIPPING STATE MACHINE ENUM
 // ============================================
-enum GrippingMode {
+enum GrippingMode : uint8_t {
   GRIPPING_MODE_OPEN,
   GRIPPING_MODE_GRASPING,
   GRIPPING_MODE_HOLDING,
@@ -19,22 +20,23 @@ enum GrippingMode {
 // ============================================
 // IIR FILTER STRUCTURE
 // ============================================
+// Single precision: the ESP32 FPU has no double support
 struct IIRFilter {
-  double previousOutput;
-  double alpha;
+  float previousOutput;
+  float alpha;
 
-  IIRFilter(double filterAlpha)
-    : previousOutput(0.0), alpha(filterAlpha) {}
+  IIRFilter(float filterAlpha)
+    : previousOutput(0.0f), alpha(filterAlpha) {}
 
   // Apply filter: y[n] = α * x[n] + (1 - α) * y[n-1]
-  double filter(double input) {
-    double output = alpha * input + (1.0 - alpha) * previousOutput;
+  float filter(float input) {
+    float output = alpha * input + (1.0f - alpha) * previousOutput;
     previousOutput = output;
     return output;
   }
 
   void reset() {
-    previousOutput = 0.0;
+    previousOutput = 0.0f;
   }
 };
 
@@ -42,83 +44,135 @@ struct IIRFilter {
 // FFT AXIS STRUCTURE
 // ============================================
 struct AxisFFT {
-  double vReal[FFT_SAMPLES];
-  double vImag[FFT_SAMPLES];
+  double* vReal;  // FFT_SAMPLES values, slice of the DSP arena
+  double* vImag;
   int index;
   ArduinoFFT<double> fft;
   const char* name;
-  bool FFT_complete;
+  FFTChannelSource source;
+  // Ownership flag: while true the arrays belong to the consumer (slip detection / debug print)
+  std::atomic<bool> FFT_complete;
 
-  AxisFFT(const char* axisName)
-    : index(0),
-      fft(ArduinoFFT<double>(vReal, vImag, FFT_SAMPLES, MAGNETIC_SENSOR_SAMPLING_FREQUENCY)),
-      name(axisName),
-      FFT_complete(false) {
+  AxisFFT()
+    : vReal(nullptr), vImag(nullptr), index(0), name(""),
+      source(FFT_SOURCE_X_HIGH_PASS), FFT_complete(false) {}
+
+  // Bind the channel to its arena buffers
+  void attach(const char* axisName, FFTChannelSource axisSource, double* real, double* imag) {
+    vReal = real;
+    vImag = imag;
+    name = axisName;
+    source = axisSource;
+    index = 0;
+    FFT_complete = false;
     for (int i = 0; i < FFT_SAMPLES; i++) {
       vReal[i] = 0;
       vImag[i] = 0;
     }
+    fft = ArduinoFFT<double>(vReal, vImag, FFT_SAMPLES, MAGNETIC_SENSOR_SAMPLING_FREQUENCY);
   }
 };
 
 // ============================================
-// DEBUG DATA STRUCTURE (Thread-safe)
+// SEQUENCE LOCK (single writer, lock-free readers)
 // ============================================
-struct DebugData {
-  bool slip_flag;
-  float slip_indicator;
-  unsigned long scan_time_us;
-  bool scan_time_exceeded;
-  bool fft_ready_to_print;
-  
-  // Added metrics for debug
-  double mag_x;
-  double mag_y;
-  double mag_z;
-  double mag_magnitude;
-  double mag_x_filtered; // Low pass
-  double mag_y_filtered;
-  double mag_z_filtered;
-
-  double mag_x_high_pass; // High pass
-  double mag_y_high_pass;
-  double mag_z_high_pass;
-  
-  float current_mA;
-  int servo_position;
-  int gripping_mode;
+// The writer never blocks: it makes the sequence odd, copies, makes it even.
+// A reader retries whenever it saw an odd sequence or the sequence changed.
+template <typename T>
+class Seqlock {
+public:
+  void write(const T& value) {
+    uint32_t seq = sequence.load(std::memory_order_relaxed);
+    sequence.store(seq + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    data = value;
+    sequence.store(seq + 2, std::memory_order_release);
+  }
+
+  // Returns the number of retries needed for a consistent copy
+  uint32_t read(T& out) const {
+    uint32_t retries = 0;
+    for (;;) {
+      uint32_t before = sequence.load(std::memory_order_acquire);
+      if ((before & 1) == 0) {
+        out = data;
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (sequence.load(std::memory_order_relaxed) == before) return retries;
+      }
+      retries++;
+    }
+  }
+
+private:
+  std::atomic<uint32_t> sequence{0};
+  T data{};
 };
 
 // ============================================
 // MAGNETIC FIELD DATA STRUCTURE
 // ============================================
 struct MagneticData {
-  double x;
-  double y;
-  double z;
-  double magnitude;
+  float x;
+  float y;
+  float z;
+  float magnitude;
   
   // Low-pass filtered values
-  double x_low_pass;
-  double y_low_pass;
-  double z_low_pass;
-  double magnitude_low_pass;
+  float x_low_pass;
+  float y_low_pass;
+  float z_low_pass;
+  float magnitude_low_pass;
   
   // High-pass filtered values
-  double x_high_pass;
-  double y_high_pass;
-  double z_high_pass;
-  double magnitude_high_pass;
+  float x_high_pass;
+  float y_high_pass;
+  float z_high_pass;
+  float magnitude_high_pass;
+  
+  uint32_t timestamp_us; // Acquisition time (micros)
+};
+
+// ============================================
+// PER-CYCLE SAMPLE RECORD (Core 1 -> Core 0 ring)
+// ============================================
+struct SampleRecord {
+  uint32_t seq;           // Increments once per magnetic sample; gaps = lost records
+  uint32_t timestamp_us;
+  float raw_x, raw_y, raw_z;          // Decoded sensor output in mT, before calibration and filtering
+  float mag_x_high_pass, mag_y_high_pass, mag_z_high_pass;
+  float current_mA;
+  int16_t servo_position;
+  uint8_t gripping_mode;
+  uint8_t slip_flag;
 };
 
 // ============================================
 // CALIBRATION DATA STRUCTURE
 // ============================================
 struct CalibrationData {
-  double x_min, x_max;
-  double y_min, y_max;
-  double z_min, z_max;
-  double x_offset, y_offset, z_offset;
+  float x_offset = 0.0f, y_offset = 0.0f, z_offset = 0.0f;
+  // Cross-axis correction applied after the offset: out = matrix * (raw - offset)
+  float matrix[3][3] = {{1.0f, 0.0f, 0.0f}, {0.0f, 1.0f, 0.0f}, {0.0f, 0.0f, 1.0f}};
+  float noise_mT = 0.0f;   // Per-axis std deviation of the last accepted window (worst axis)
+  uint32_t updates = 0;    // Accepted calibration windows
+  bool valid = false;      // False until the first still window has been seen
+  bool restored = false;   // Zero loaded from NVS at boot; the first window replaces it outright
+};
+
+// ============================================
+// RAW MAGNETIC SAMPLE (TLV493D COUNTS)
+// ============================================
+struct MagneticRaw {
+  int16_t x, y, z;   // 12-bit two's complement, TLV493D_MT_PER_LSB per count
+  uint8_t frame;     // FRM field of register 3 (increments per conversion)
+};
+
+// Sample handed from the acquisition task to the control task
+struct AcquiredSample {
+  MagneticRaw raw;
+  uint32_t cycles;        // CPU cycle counter at read completion (bus task core)
+  uint32_t timestamp_us;  // Same instant in micros()
+  uint32_t sequence;      // Increments per new conversion (duplicates are not published)
 };
 
 // ============================================
@@ -132,5 +186,43 @@ struct ButtonState {
   bool button_5;  // automatic mode
 };
 
+// ============================================
+// CONTROL STATE (owned by the control task)
+// ============================================
+// Everything one scan cycle reads and writes. Logic modules receive it
+// explicitly instead of touching globals; other cores only see the copy
+// published in DebugData.
+struct ControlState {
+  MagneticData mag = {};          // Latest filtered magnetic sample
+  float current_mA = 0.0f;        // Filtered servo current
+  float slip_indicator = 0.0f;
+
+  // GrippingFSM timers (millis)
+  uint32_t last_reaction_time = 0;
+  uint32_t last_slip_or_entry_time = 0;
+  uint32_t last_backoff_time = 0;
+
+  int16_t servo_position = SERVO_FULLY_OPEN;
+  GrippingMode gripping_mode = GRIPPING_MODE_OPEN;
+  ButtonState buttons = {false, false, false, false, false};
+  bool slip_flag = false;
+  bool new_slip_data_ready = false;
+  bool calibrated = false;        // Magnetic zero known (grasping is refused until then)
+  uint16_t slip_reactions = 0;    // REACTING entries since boot (wraps)
+};
+
+// ============================================
+// DEBUG DATA STRUCTURE (published through a Seqlock)
+// ============================================
+struct alignas(32) DebugData {
+  ControlState control;           // Read-only copy of the control task state
+  
+  unsigned long scan_time_us;
+  bool scan_time_exceeded;
+  unsigned long wake_latency_us;
+  bool timing_fault;
+  bool i2c_healthy;
+};
+
 #endif // TYPES_H
 
@@ -0,0 +1,149 @@
+"""
+Fit the magnetic sensor calibration (offset vector + 3x3 correction matrix)
+from recordings made with signal_analysis_gui.py.
+
+A recording must contain the raw stream ("rmx", "rmy", "rmz") and the grip
+mode ("grp"). Samples taken while OPEN (grp 0) give the zero offset; samples
+in the loaded modes are a sweep that excites one axis. For every axis with a
+sweep, the least-squares gain of each axis onto the excited one (through the
+zero offset) is that axis' column of the mixing matrix A. Axes without a
+sweep keep a unit column. The correction applied on the device is M = A^-1:
+
+    corrected = M * (raw - offset)
+
+The streamed "rmx..rmz" values are already offset-corrected by the device's
+online zero and multiplied by the matrix loaded at the time of recording, so
+the OPEN samples only give the residual offset used as fit reference, and the
+matrix sent back is the fitted one composed with --applied (identity if the
+recording was made without a matrix). The device keeps learning its own zero.
+
+Cross-axis leakage (RMS of the off-axis components / RMS of the excited axis)
+is reported before and after correction, on the fitted half of the sweep and
+on the held-out second half.
+
+Usage:
+    python fit_calibration.py --sweep z=../data/<recording>/raw_data.txt
+    python fit_calibration.py --sweep z=press.txt --sweep x=shear_x.txt --port COM5
+"""
+import argparse
+import json
+import sys
+
+import numpy as np
+
+AXES = "xyz"
+OPEN_MODE = 0
+DEFAULT_LOADED_MODES = (2, 3)  # HOLDING, REACTING (4 is OPENING: release transients)
+DEFAULT_BAUD_RATE = 2000000
+
+
+def load_recording(path):
+    """Return (samples Nx3, modes N) from a JSON-lines recording."""
+    samples, modes = [], []
+    with open(path) as f:
+        for line in f:
+            try:
+                msg = json.loads(line)
+            except json.JSONDecodeError:
+                continue
+            if "rmx" not in msg or "grp" not in msg:
+                continue
+            samples.append((msg["rmx"], msg["rmy"], msg["rmz"]))
+            modes.append(msg["grp"])
+    if not samples:
+        sys.exit(f"{path}: no raw magnetic samples with grip mode (enable mag_raw and servo streams)")
+    return np.asarray(samples, dtype=float), np.asarray(modes)
+
+
+def mixing_column(d, axis):
+    """Least-squares gain of every axis onto the excited one (through zero, unit on `axis`)."""
+    excited = d[:, axis]
+    column = d.T @ excited / (excited @ excited)
+    if np.argmax(np.sqrt(np.mean(d ** 2, axis=0))) != axis:
+        print(f"  warning: {AXES[axis]} is not the strongest axis in its sweep; check the recording")
+    return column
+
+
+def axis_ratios(d, axis):
+    """RMS of every axis relative to the excited axis."""
+    rms = np.sqrt(np.mean(d ** 2, axis=0))
+    return rms / rms[axis]
+
+
+def leakage(d, axis):
+    """RMS of the off-axis components relative to the excited axis."""
+    on = np.sqrt(np.mean(d[:, axis] ** 2))
+    off = np.sqrt(np.mean(np.sum(np.delete(d, axis, axis=1) ** 2, axis=1)))
+    return off / on if on > 0 else float("nan")
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("--sweep", action="append", required=True, metavar="AXIS=FILE",
+                        help="recording whose loaded samples excite AXIS (x, y or z)")
+    parser.add_argument("--modes", default=",".join(map(str, DEFAULT_LOADED_MODES)),
+                        help="grip modes counted as loaded (default: %(default)s)")
+    parser.add_argument("--applied", metavar="M00,M01,...,M22",
+                        help="row-major matrix active during the recording (\"matrix\" of the calib report)")
+    parser.add_argument("--port", help="send the fitted calibration to the device on this serial port")
+    args = parser.parse_args()
+
+    loaded_modes = [int(m) for m in args.modes.split(",")]
+    mixing = np.eye(3)
+    baselines, sweeps = [], {}
+
+    for spec in args.sweep:
+        axis_name, _, path = spec.partition("=")
+        if axis_name not in AXES or not path:
+            sys.exit(f"bad --sweep '{spec}', expected AXIS=FILE")
+        samples, modes = load_recording(path)
+        baselines.append(samples[modes == OPEN_MODE])
+        loaded = samples[np.isin(modes, loaded_modes)]
+        if len(loaded) < 100:
+            sys.exit(f"{path}: only {len(loaded)} loaded samples")
+        sweeps[AXES.index(axis_name)] = loaded
+        print(f"{path}: {len(samples)} samples, {len(loaded)} loaded ({axis_name} sweep)")
+
+    offset = np.concatenate(baselines).mean(axis=0)
+
+    # Fit on the first half of every sweep, keep the second half for evaluation
+    for axis, loaded in sweeps.items():
+        half = len(loaded) // 2
+        mixing[:, axis] = mixing_column(loaded[:half] - offset, axis)
+    matrix = np.linalg.inv(mixing)
+
+    print(f"\noffset [mT]: {np.round(offset, 4).tolist()}")
+    print("matrix:")
+    for row in matrix:
+        print("  " + "  ".join(f"{v:+.5f}" for v in row))
+
+    print("\nCross-axis leakage (off-axis RMS / on-axis RMS):")
+    for axis, loaded in sweeps.items():
+        half = len(loaded) // 2
+        for label, part in (("fit", loaded[:half]), ("held-out", loaded[half:])):
+            d = part - offset
+            before = leakage(d, axis)
+            after = leakage(d @ matrix.T, axis)
+            print(f"  {AXES[axis]} sweep, {label:8s}: {before:.3f} -> {after:.3f} "
+                  f"({100.0 * (1.0 - after / before):.1f}% reduction)")
+            for other in range(3):
+                if other != axis:
+                    print(f"      {AXES[other]}/{AXES[axis]}: {axis_ratios(d, axis)[other]:.3f} -> "
+                          f"{axis_ratios(d @ matrix.T, axis)[other]:.3f}")
+
+    applied = np.eye(3)
+    if args.applied:
+        applied = np.asarray([float(v) for v in args.applied.split(",")]).reshape(3, 3)
+    device_matrix = matrix @ applied
+    command = json.dumps({"calmatrix": [round(float(v), 6) for v in device_matrix.flatten()]}, separators=(",", ":"))
+    print(f"\nDevice command:\n{command}")
+
+    if args.port:
+        import serial
+        with serial.Serial(args.port, DEFAULT_BAUD_RATE, timeout=1) as ser:
+            ser.write((command + "\n").encode())
+            print(f"Sent to {args.port}")
+
+
+if __name__ == "__main__":
+    main()